@@ -1 +1,10 @@
-include("${CMAKE_CURRENT_LIST_DIR}/sonata-targets.cmake")
\ No newline at end of file
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+find_dependency(ZLIB)
+
+include("${CMAKE_CURRENT_LIST_DIR}/sonata-targets.cmake")
+
+if(EXISTS "${CMAKE_CURRENT_LIST_DIR}/sonata-mpi-targets.cmake")
+    find_dependency(MPI COMPONENTS C)
+    include("${CMAKE_CURRENT_LIST_DIR}/sonata-mpi-targets.cmake")
+endif()
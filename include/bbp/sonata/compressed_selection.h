@@ -0,0 +1,119 @@
+#pragma once
+
+#include "common.h"
+#include "selection.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bbp {
+namespace sonata {
+
+namespace detail {
+/// One block of 2^16 consecutive IDs of a `CompressedSelection`.
+///
+/// Depending on what is smallest, the low 16 bits of the IDs in the block
+/// are stored as: a sorted array of values, a list of runs `[first, last]`,
+/// or a bitmap with one bit per possible ID.
+struct SONATA_API CompressedBlock {
+    enum class Kind : uint8_t {
+        array = 0,
+        runs = 1,
+        bitmap = 2,
+    };
+
+    /// The upper 48 bits shared by every ID in this block.
+    uint64_t key = 0;
+    Kind kind = Kind::array;
+    /// Number of IDs in this block.
+    uint32_t cardinality = 0;
+    /// For `array`: the sorted values; for `runs`: pairs of `first, last`.
+    std::vector<uint16_t> values;
+    /// For `bitmap`: 1024 words, bit `i` is set if ID `i` is in the block.
+    std::vector<uint64_t> bitmap;
+};
+
+bool SONATA_API operator==(const CompressedBlock&, const CompressedBlock&);
+}  // namespace detail
+
+/**
+ * Compressed representation of a set of IDs.
+ *
+ * The IDs are split into blocks of 2^16 consecutive values. Each block is
+ * stored either as an array, a list of runs or a bitmap, whichever is
+ * smallest. This keeps sparse selections, e.g. thousands of isolated IDs,
+ * compact while set operations run in linear time in the number of blocks
+ * and, for dense blocks, operate on whole 64-bit words.
+ *
+ * Unlike `Selection`, a CompressedSelection is a set: the order of the
+ * ranges it was created from, and any overlap between them, is not retained.
+ * Hence, `ranges()` is always canonical, i.e. sorted, non-overlapping and
+ * without touching ranges.
+ */
+class SONATA_API CompressedSelection
+{
+  public:
+    using Value = Selection::Value;
+    using Values = Selection::Values;
+    using Range = Selection::Range;
+    using Ranges = Selection::Ranges;
+
+    CompressedSelection() = default;
+    explicit CompressedSelection(const Selection& selection);
+    explicit CompressedSelection(const Ranges& ranges);
+
+    static CompressedSelection fromValues(const Values& values);
+
+    /**
+     * Get the canonical list of ranges constituting the CompressedSelection
+     */
+    Ranges ranges() const;
+
+    /**
+     * Sorted array of IDs constituting the CompressedSelection
+     */
+    Values flatten() const;
+
+    /**
+     * Total number of elements constituting the CompressedSelection
+     */
+    size_t flatSize() const;
+
+    bool empty() const;
+
+    /**
+     * True if `value` is part of the CompressedSelection
+     */
+    bool contains(Value value) const;
+
+    /**
+     * Convert to a canonical `Selection`
+     */
+    Selection toSelection() const;
+
+    /**
+     * Approximate number of bytes used to store the IDs
+     */
+    size_t memoryUsage() const;
+
+    const std::vector<detail::CompressedBlock>& blocks() const;
+
+  private:
+    explicit CompressedSelection(std::vector<detail::CompressedBlock> blocks);
+
+    std::vector<detail::CompressedBlock> blocks_;
+
+    friend CompressedSelection SONATA_API operator&(const CompressedSelection&,
+                                                    const CompressedSelection&);
+    friend CompressedSelection SONATA_API operator|(const CompressedSelection&,
+                                                    const CompressedSelection&);
+};
+
+bool SONATA_API operator==(const CompressedSelection&, const CompressedSelection&);
+bool SONATA_API operator!=(const CompressedSelection&, const CompressedSelection&);
+
+CompressedSelection SONATA_API operator&(const CompressedSelection&, const CompressedSelection&);
+CompressedSelection SONATA_API operator|(const CompressedSelection&, const CompressedSelection&);
+
+}  // namespace sonata
+}  // namespace bbp
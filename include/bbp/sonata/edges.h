@@ -75,12 +75,16 @@ class SONATA_API EdgePopulation: public Population
 
     /**
      * Write bidirectional node->edge indices to EdgePopulation HDF5.
+     *
+     * Takes the same lock as the populations read from the file with
+     * `hdf5_reader`, see `Hdf5ReaderOptions::locking`.
      */
     static void writeIndices(const std::string& h5FilePath,
                              const std::string& population,
                              uint64_t sourceNodeCount,
                              uint64_t targetNodeCount,
-                             bool overwrite = false);
+                             bool overwrite = false,
+                             const Hdf5Reader& hdf5_reader = Hdf5Reader());
 };
 
 //--------------------------------------------------------------------------------------------------
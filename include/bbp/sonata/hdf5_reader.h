@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -22,6 +29,18 @@ class Hdf5PluginRead1DInterface
     /// is obtained from a `HighFive::File` opened via `this->openFile`.
     virtual std::vector<T> readSelection(const HighFive::DataSet& dset,
                                          const Selection& selection) const = 0;
+
+    /// Read the selected subset of the one-dimensional array into `out`.
+    ///
+    /// Same as `readSelection`, but writes the values to `out`, which must
+    /// have room for `selection.flatSize()` values. The default
+    /// implementation copies the result of `readSelection`.
+    virtual void readSelectionInto(const HighFive::DataSet& dset,
+                                   const Selection& selection,
+                                   T* out) const {
+        auto values = readSelection(dset, selection);
+        std::move(values.begin(), values.end(), out);
+    }
 };
 
 template <class T>
@@ -30,6 +49,30 @@ class Hdf5PluginRead2DInterface
   public:
     virtual ~Hdf5PluginRead2DInterface() = default;
 
+    /// Read the Cartesian product of the two selections.
+    ///
+    /// Both selections are canonical, i.e. sorted and non-overlapping. The dataset
+    /// is obtained from a `HighFive::File` opened via `this->openFile`.
+    ///
+    /// The values are returned in row-major order. If `T` is an `std::array`,
+    /// each element holds that many consecutive values of one row.
+    ///
+    /// Optional for plugins; the default implementation throws a `SonataError`.
+    virtual std::vector<T> readSelection(const HighFive::DataSet& /* dset */,
+                                         const Selection& /* xsel */,
+                                         const Selection& /* ysel */) const {
+        throw SonataError("Reading two-dimensional selections of this type is not supported by "
+                          "this plugin");
+    }
+};
+
+/// Reading the edge indices is required from every plugin.
+template <>
+class Hdf5PluginRead2DInterface<std::array<uint64_t, 2>>
+{
+  public:
+    virtual ~Hdf5PluginRead2DInterface() = default;
+
     /// Read the Cartesian product of the two selections.
     ///
     /// Both selections are canonical, i.e. sorted and non-overlapping. The dataset
@@ -58,6 +101,338 @@ class Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>
     virtual HighFive::File openFile(const std::string& path) const = 0;
 };
 
+/// I/O statistics of one dataset, see `Hdf5ReaderStatistics`.
+struct SONATA_API Hdf5DatasetStatistics {
+    /// Number of buckets of `latency_histogram`.
+    static constexpr size_t n_latency_buckets = 32;
+
+    /// Number of HDF5 read calls.
+    size_t n_read_calls = 0;
+
+    /// Number of elements of the selections passed to the reader.
+    size_t n_elements_requested = 0;
+
+    /// Number of elements read from the dataset, including the gaps between
+    /// ranges which were merged into one block.
+    size_t n_elements_read = 0;
+
+    /// Number of selections which were not canonical and had to be sorted
+    /// and merged before reading.
+    size_t n_canonicalizations = 0;
+
+    /// Total wall time spent in HDF5 read calls, in seconds.
+    double read_seconds = 0.0;
+
+    /// Histogram of the wall time per HDF5 read call.
+    ///
+    /// Bucket `0` counts the calls shorter than 1 microsecond, bucket `i` the
+    /// calls taking from `2^(i-1)` up to `2^i` microseconds. The last bucket
+    /// also counts all longer calls.
+    std::array<size_t, n_latency_buckets> latency_histogram{};
+};
+
+/// Collects I/O statistics of the default `Hdf5Reader` plugin, per dataset.
+///
+/// Attach a collector via `Hdf5ReaderOptions::statistics`. The same collector
+/// may be shared by several readers and used from several threads. This is
+/// meant to tune the merge thresholds of `Hdf5ReaderOptions`, e.g. the ratio
+/// of `n_elements_read` to `n_elements_requested` is the read amplification
+/// caused by merging.
+class SONATA_API Hdf5ReaderStatistics
+{
+  public:
+    /// Statistics keyed by the path of the dataset.
+    using Snapshot = std::map<std::string, Hdf5DatasetStatistics>;
+
+    /// A copy of the statistics collected so far.
+    Snapshot snapshot() const;
+
+    /// Discard all statistics collected so far.
+    void reset();
+
+    /// Record a selection of `n_elements` passed to the reader.
+    void recordRequest(const std::string& dataset, size_t n_elements);
+
+    /// Record one HDF5 read call of `n_elements`, which took `seconds`.
+    void recordRead(const std::string& dataset, size_t n_elements, double seconds);
+
+    /// Record a selection which was canonicalized before reading it.
+    void recordCanonicalization(const std::string& dataset);
+
+  private:
+    mutable std::mutex mutex_;
+    Snapshot statistics_;
+};
+
+/// Memory-bounded LRU cache of blocks read by the default `Hdf5Reader` plugin.
+///
+/// One-dimensional datasets are split into aligned blocks of `block_bytes`
+/// bytes. If a cache is attached via `Hdf5ReaderOptions::block_cache`,
+/// selections are read by whole blocks, and blocks read before are taken
+/// from the cache instead of the file. This helps when the same or nearby
+/// selections are read repeatedly, e.g. in interactive analysis.
+///
+/// Blocks are identified by the name of the file, the path of the dataset and
+/// the type they were read as; the cache must be cleared if a file is
+/// modified. The cache is thread-safe and can be shared by several readers.
+class SONATA_API Hdf5BlockCache
+{
+  public:
+    /// A cache holding at most `max_bytes` bytes of blocks of `block_bytes` bytes.
+    explicit Hdf5BlockCache(size_t max_bytes, size_t block_bytes = size_t(1) << 20);
+    ~Hdf5BlockCache();
+
+    Hdf5BlockCache(const Hdf5BlockCache&) = delete;
+    Hdf5BlockCache& operator=(const Hdf5BlockCache&) = delete;
+
+    size_t maxBytes() const;
+    size_t blockBytes() const;
+
+    /// Number of bytes of the blocks currently cached.
+    size_t bytes() const;
+
+    /// Number of blocks found in the cache.
+    size_t hits() const;
+
+    /// Number of blocks which had to be read from the file.
+    size_t misses() const;
+
+    /// Remove all blocks; the counters are not reset.
+    void clear();
+
+    /// Identifies one block of a dataset.
+    struct Key {
+        std::string file;
+        std::string dataset;
+        std::string type;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /// The block `key`, or `nullptr` if it isn't cached. Counts a hit or miss.
+    std::shared_ptr<const void> find(const Key& key);
+
+    /// Add the block `key`, of `bytes` bytes, evicting the least recently used blocks.
+    void insert(const Key& key, std::shared_ptr<const void> block, size_t bytes);
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Memory-bounded LRU cache of whole attribute columns of a `Population`.
+///
+/// If a cache is attached via `Hdf5ReaderOptions::column_cache`, the first
+/// read of an attribute reads all its values and keeps them in the cache;
+/// later reads, of any selection, are served from memory. This suits
+/// repeatedly filtering or matching the same attributes, e.g. when
+/// materializing node sets. Columns which don't fit in the cache are read from
+/// the file as usual.
+///
+/// Columns are identified by the name of the file, the path of the dataset
+/// and the type they were read as; the cache must be cleared if a file is
+/// modified. The cache is thread-safe and can be shared by several readers,
+/// so that all their populations share one memory budget.
+class SONATA_API Hdf5ColumnCache
+{
+  public:
+    /// A cache holding at most `max_bytes` bytes of columns.
+    explicit Hdf5ColumnCache(size_t max_bytes);
+    ~Hdf5ColumnCache();
+
+    Hdf5ColumnCache(const Hdf5ColumnCache&) = delete;
+    Hdf5ColumnCache& operator=(const Hdf5ColumnCache&) = delete;
+
+    size_t maxBytes() const;
+
+    /// Number of bytes of the columns currently cached.
+    size_t bytes() const;
+
+    /// Number of columns found in the cache.
+    size_t hits() const;
+
+    /// Number of columns which had to be read from the file.
+    size_t misses() const;
+
+    /// Remove all columns, and forget which ones are too large; the counters
+    /// are not reset.
+    void clear();
+
+    /// Identifies one column.
+    struct Key {
+        std::string file;
+        std::string dataset;
+        std::string type;
+    };
+
+    /// The column `key`, or `nullptr` if it isn't cached. Counts a hit or miss.
+    std::shared_ptr<const void> find(const Key& key);
+
+    /// Add the column `key`, of `bytes` bytes, evicting the least recently used columns.
+    ///
+    /// Returns `false`, without caching it, if the column is larger than the
+    /// whole cache; the column is then remembered as too large.
+    bool insert(const Key& key, std::shared_ptr<const void> column, size_t bytes);
+
+    /// Was the column `key` found too large to be cached by `insert`?
+    bool isTooLarge(const Key& key) const;
+
+    /// Remove the columns of the dataset `dataset` of `file`, read as any type,
+    /// and forget whether they were too large.
+    void erase(const std::string& file, const std::string& dataset);
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Options of the default `Hdf5Reader` plugin.
+///
+/// Canonical selections are read with a merge-read-extract algorithm: ranges
+/// separated by small gaps are merged into larger blocks, each block is read
+/// with a single HDF5 call, and the requested values are then extracted from
+/// it. These options control how ranges are merged.
+struct SONATA_API Hdf5ReaderOptions {
+    /// How a canonical selection of a one-dimensional dataset is read.
+    enum class ReadMode {
+        /// Choose between `merge` and `hyperslab` based on the number of
+        /// ranges, and on how many unneeded values merging would read. The
+        /// thresholds were measured on a local file. Chunked datasets read
+        /// by whole chunks, see `chunk_aware`, are always merged.
+        automatic,
+        /// Merge ranges into blocks, read one block per HDF5 call and
+        /// extract the requested values.
+        merge,
+        /// Read the union of all ranges with a single HDF5 call, leaving the
+        /// gather to HDF5.
+        hyperslab,
+    };
+
+    /// The read mode; `merge` unless changed, since a single hyperslab can be
+    /// much slower on fragmented selections.
+    ReadMode read_mode = ReadMode::merge;
+
+    /// Ranges separated by a gap of fewer bytes are read as one block.
+    size_t min_gap_bytes = 4 << 20;
+
+    /// Blocks of one-dimensional datasets are not extended once they reach
+    /// this many bytes.
+    size_t max_aggregated_block_bytes = 4 << 20;
+
+    /// Blocks of two-dimensional datasets are not extended once they reach
+    /// this many bytes.
+    size_t max_aggregated_block_bytes_2d = size_t(512) << 20;
+
+    /// Take the chunk layout of chunked datasets into account.
+    ///
+    /// HDF5 reads, and decompresses, chunked datasets one chunk at a time.
+    /// If enabled, the thresholds above are rounded to whole chunks, gaps
+    /// within compressed datasets are only merged if no unneeded chunk is
+    /// read, and blocks that share a chunk are merged, so that each chunk is
+    /// read once.
+    bool chunk_aware = true;
+
+    /// Number of threads reading the merged blocks of one selection.
+    ///
+    /// With more than one thread, blocks are read in the background while
+    /// the calling thread extracts the requested values from the blocks
+    /// already read. HDF5 makes its calls one at a time, even if built
+    /// threadsafe, hence the reads themselves don't overlap; only reading and
+    /// extracting do. Not used for selections read as a hyperslab.
+    ///
+    /// Values of large unsorted or overlapping selections of a `Population`
+    /// are also copied into place by this many threads.
+    size_t n_reader_threads = 1;
+
+    /// Number of blocks read ahead of the block being extracted.
+    ///
+    /// If non-zero, blocks are read in the background while the values of
+    /// the previous blocks are extracted; blocks longer than
+    /// `max_aggregated_block_bytes` are split so that even a single large
+    /// range is read in pieces. The default of `0` reads and extracts one block
+    /// after the other. With several `n_reader_threads`, the default depth is
+    /// twice the number of threads.
+    size_t prefetch_depth = 0;
+
+    /// Number of threads decompressing the chunks of compressed datasets.
+    ///
+    /// If non-zero, one-dimensional datasets compressed with deflate (gzip),
+    /// optionally after shuffle, are read one raw chunk at a time with
+    /// `H5Dread_chunk`, bypassing the filter pipeline of HDF5. This many
+    /// threads, including the calling one, then decompress the chunks in
+    /// parallel, outside of HDF5, and copy the requested values to the
+    /// output. Only applies to datasets stored in the native representation
+    /// of the requested type; all other datasets are read as usual.
+    size_t n_decompression_threads = 0;
+
+    /// If set, I/O statistics are recorded in this collector.
+    std::shared_ptr<Hdf5ReaderStatistics> statistics;
+
+    /// If set, one-dimensional datasets are read by whole blocks, which are
+    /// kept in this cache. Selections are then never read as a hyperslab.
+    std::shared_ptr<Hdf5BlockCache> block_cache;
+
+    /// If set, attributes of a `Population` are read as whole columns, which
+    /// are kept in this cache, see `Hdf5ColumnCache`.
+    std::shared_ptr<Hdf5ColumnCache> column_cache;
+
+    /// Read datasets straight from a read-only memory map of the file.
+    ///
+    /// Only applies to numeric datasets with contiguous layout, which are
+    /// hence neither chunked nor compressed, stored in the native byte order
+    /// of the requested type, and to files opened with the default driver.
+    /// These are read without HDF5, by copying the selected values from the
+    /// mapped pages; all other datasets are read as usual. The files must not
+    /// be modified while they are mapped.
+    bool memory_map = false;
+
+    /// If non-zero, read contiguous datasets with Linux io_uring, keeping up
+    /// to this many reads in flight.
+    ///
+    /// The merged blocks of a selection are located in the file and all
+    /// submitted at once, rather than read one at a time through HDF5. As
+    /// these reads are cheap, ranges are only merged across gaps of up to a
+    /// page. Applies to the same datasets as `memory_map`, which takes
+    /// precedence; all other datasets, and all datasets on systems without
+    /// io_uring, are read as usual.
+    size_t io_uring_queue_depth = 0;
+
+    /// How libsonata keeps threads from using HDF5 at the same time.
+    enum class Locking {
+        /// `none` if HDF5 was built thread-safe, `global` otherwise.
+        automatic,
+        /// All threads take turns, for all files.
+        global,
+        /// Threads take turns per file, so that different files, e.g. nodes
+        /// and edges, can be read at the same time.
+        per_file,
+        /// No lock is taken by libsonata; HDF5 serializes its calls itself.
+        none,
+    };
+
+    /// The locking strategy of the populations read with this reader.
+    ///
+    /// The lock is only held for the HDF5 calls themselves, not while values
+    /// are reordered, taken from a `column_cache`, or enumerations are
+    /// resolved to strings. Neither is it held while ranges are merged, values
+    /// are extracted from blocks or copied from a `block_cache`, chunks are
+    /// decompressed, or values are read from a memory map or with io_uring.
+    /// User supplied plugins are called with the lock held. Unless HDF5 was
+    /// built thread-safe, HDF5 keeps state shared by all files, and the global
+    /// lock is always used.
+    Locking locking = Locking::automatic;
+};
+
+class Hdf5Reader;
+
+namespace detail {
+struct ReaderResources;
+
+/// The memory mapped files, and other state, of the default plugin of
+/// `reader`; `nullptr` for user supplied plugins.
+const ReaderResources* readerResources(const Hdf5Reader& reader);
+}  // namespace detail
+
 /// Abstraction for reading HDF5 datasets.
 ///
 /// The Hdf5Reader provides an interface for reading canonical selections from
@@ -138,14 +513,32 @@ class SONATA_API Hdf5Reader
 #endif
                                           std::string>;
 
-    using supported_2D_types = std::tuple<std::array<uint64_t, 2>>;
+    using supported_2D_types = std::tuple<uint8_t,
+                                          uint16_t,
+                                          uint32_t,
+                                          uint64_t,
+                                          int8_t,
+                                          int16_t,
+                                          int32_t,
+                                          int64_t,
+                                          float,
+                                          double,
+                                          std::array<uint64_t, 2>>;
 
     /// Create a valid Hdf5Reader with the default plugin.
     Hdf5Reader();
 
+    /// Create a valid Hdf5Reader with the default plugin configured by `options`.
+    explicit Hdf5Reader(const Hdf5ReaderOptions& options);
+
     /// Create an Hdf5Reader with a user supplied plugin.
     Hdf5Reader(std::shared_ptr<Hdf5PluginInterface<supported_1D_types, supported_2D_types>> impl);
 
+    /// The options of the default plugin.
+    ///
+    /// User supplied plugins are not affected by them.
+    const Hdf5ReaderOptions& options() const;
+
     /// Read the selected subset of the one-dimensional array.
     ///
     /// Both selections are canonical, i.e. sorted and non-overlapping. The dataset
@@ -156,6 +549,19 @@ class SONATA_API Hdf5Reader
                                                                                      selection);
     }
 
+    /// Read the selected subset of the one-dimensional array into `out`.
+    ///
+    /// Same as `readSelection`, but writes the values to `out`, which must
+    /// have room for `selection.flatSize()` values.
+    template <class T>
+    void readSelectionInto(const HighFive::DataSet& dset,
+                           const Selection& selection,
+                           T* out) const {
+        static_cast<const Hdf5PluginRead1DInterface<T>&>(*impl).readSelectionInto(dset,
+                                                                                 selection,
+                                                                                 out);
+    }
+
     /// Open the HDF5.
     ///
     /// The dataset passed to `readSelection` must be obtained from a file open
@@ -166,6 +572,9 @@ class SONATA_API Hdf5Reader
     ///
     /// Both selections are canonical, i.e. sorted and non-overlapping. The dataset
     /// is obtained from a `HighFive::File` opened via `this->openFile`.
+    ///
+    /// The values are returned in row-major order. If `T` is an `std::array`,
+    /// each element holds that many consecutive values of one row.
     template <class T>
     std::vector<T> readSelection(const HighFive::DataSet& dset,
                                  const Selection& xsel,
@@ -177,6 +586,9 @@ class SONATA_API Hdf5Reader
 
   private:
     std::shared_ptr<Hdf5PluginInterface<supported_1D_types, supported_2D_types>> impl;
+    Hdf5ReaderOptions options_;
+
+    friend const detail::ReaderResources* detail::readerResources(const Hdf5Reader& reader);
 };
 
 }  // namespace sonata
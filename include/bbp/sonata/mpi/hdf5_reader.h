@@ -0,0 +1,88 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <bbp/sonata/common.h>
+#include <bbp/sonata/hdf5_reader.h>
+
+#if defined(SONATA_MPI_DLL_EXPORTS)
+#define SONATA_MPI_API SONATA_DLLEXPORT
+#else
+#define SONATA_MPI_API SONATA_DLLIMPORT
+#endif
+
+namespace bbp {
+namespace sonata {
+namespace mpi {
+
+/// Options of the collective `Hdf5Reader`, see `makeCollectiveReader`.
+struct SONATA_MPI_API CollectiveReaderOptions {
+    /// Read metadata, e.g. when opening groups and datasets, collectively.
+    ///
+    /// Metadata is then read once, by one rank, and broadcast to all other
+    /// ranks.
+    bool collective_metadata = true;
+
+    /// Read the values of datasets with collective MPI-IO transfers.
+    bool collective_transfer = true;
+
+    /// Aggregate the selections of all ranks with two-phase I/O.
+    ///
+    /// A few aggregator ranks read large contiguous regions, covering the
+    /// small selections of many ranks, and redistribute the values. Only
+    /// applies to collective transfers.
+    bool two_phase_aggregation = false;
+
+    /// Number of aggregator ranks for two-phase I/O; `0` lets MPI-IO decide.
+    int n_aggregators = 0;
+};
+
+/// Create an `Hdf5Reader` for MPI collective I/O on `comm`.
+///
+/// Files are opened with the MPI-IO driver of HDF5. Canonical selections of
+/// numeric datasets are read with a single, collective `H5Dread`; datasets
+/// of strings are read independently. Hence, libsonata must be used in an
+/// MPI-collective manner, see `Hdf5Reader`: every rank of `comm` must open the
+/// same files and read the same attributes, in the same order. The
+/// selections, however, may differ between ranks, and may be empty.
+///
+/// `comm` must remain valid while files are being opened.
+///
+/// Requires HDF5 built with MPI support.
+///
+/// There are no Python bindings for this function: the `libsonata` module is
+/// built without MPI and against a serial HDF5, so it can't load `sonata_mpi`.
+/// In Python, `libsonata.make_collective_reader` uses the separately installed
+/// `libsonata_mpi` package instead.
+SONATA_MPI_API Hdf5Reader makeCollectiveReader(MPI_Comm comm,
+                                               const CollectiveReaderOptions& options = {});
+
+/// Options of the aggregating `Hdf5Reader`, see `makeAggregatingReader`.
+struct SONATA_MPI_API AggregatingReaderOptions {
+    /// Number of consecutive ranks sharing one aggregator.
+    int group_size = 16;
+
+    /// Options of the reader used by the aggregators.
+    Hdf5ReaderOptions reader;
+};
+
+/// Create an `Hdf5Reader` which aggregates the reads of groups of ranks of `comm`.
+///
+/// Ranks are split into groups of `options.group_size` consecutive ranks.
+/// For every read, the first rank of each group, the aggregator, gathers the
+/// selections of its group, reads their union with a single call to the
+/// default plugin, configured by `options.reader`, and scatters the values
+/// back. For two-dimensional reads, the aggregator reads the Cartesian product
+/// of the unions of the rows and of the columns.
+///
+/// Only plain MPI messages are used, hence this works with serial builds of
+/// HDF5. Files are opened independently on every rank. As for any collective
+/// reader, libsonata must be used in an MPI-collective manner, see
+/// `Hdf5Reader`: every rank of `comm` must open the same files and read the
+/// same attributes, in the same order.
+SONATA_MPI_API Hdf5Reader makeAggregatingReader(MPI_Comm comm,
+                                                const AggregatingReaderOptions& options = {});
+
+}  // namespace mpi
+}  // namespace sonata
+}  // namespace bbp
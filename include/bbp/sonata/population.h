@@ -92,6 +92,58 @@ class SONATA_API Population
                                 const Selection& selection,
                                 const T& defaultValue) const;
 
+    /**
+     * Get the values of several attributes for the same {element} Selection
+     *
+     * Same as calling `getAttribute` for each of the `names`, but the
+     * selection is prepared only once: if it isn't sorted and free of
+     * overlaps, the canonical selection read from the file and the order in
+     * which to return the values are computed once, and reused for every
+     * attribute.
+     *
+     * \param names are the attributes to read, all of which are read as `T`
+     * \param selection is a selection to retrieve the attribute values from
+     * \returns the values of each attribute, in the order of `names`
+     * \throw if there is no such attribute for the population
+     */
+    template <typename T>
+    std::vector<std::vector<T>> getAttributes(const std::vector<std::string>& names,
+                                              const Selection& selection) const;
+
+    /**
+     * Read attribute values for given {element} Selection into `out`
+     *
+     * Same as `getAttribute`, but writes the values to `out`, which must have
+     * room for `selection.flatSize()` values. Only numeric types are
+     * supported; for explicit enumerations the indices are read.
+     *
+     * \param name is a string to allow attributes not defined in spec
+     * \param selection is a selection to retrieve the attribute values from
+     * \param out is where the values are written to
+     * \throw if there is no such attribute for the population
+     */
+    template <typename T>
+    void getAttributeInto(const std::string& name, const Selection& selection, T* out) const;
+
+    /**
+     * Read-only view of the attribute values of the {element}s in `range`
+     *
+     * The values are not copied, but accessed straight in a memory map of
+     * the file, which the view keeps alive. The map is shared with all reads
+     * and views of the same reader. This requires a reader with
+     * `Hdf5ReaderOptions::memory_map`, and an attribute which can be mapped,
+     * see there.
+     *
+     * \param name is a string to allow attributes not defined in spec
+     * \param range is the half-open range of {element}s
+     * \returns `nullptr` if the attribute can't be mapped as `T`
+     * \throw if there is no such attribute for the population
+     * \throw if the range is out of bounds
+     */
+    template <typename T>
+    std::shared_ptr<const T> getAttributeView(const std::string& name,
+                                              const Selection::Range& range) const;
+
     /**
      * Get enumeration values for given attribute and {element} Selection
      *
@@ -166,6 +218,25 @@ class SONATA_API Population
     template <typename T>
     Selection filterAttribute(const std::string& name, std::function<bool(const T)> pred) const;
 
+    /**
+     * Read attributes into the column cache of the reader
+     *
+     * Reads all values of each of the `names`, as the type they are stored
+     * as, into `Hdf5ReaderOptions::column_cache`, so that later reads, and
+     * filtering or matching, of these attributes are served from memory. For
+     * explicit enumerations, the indices and the enumeration values are read.
+     *
+     * \param names are the attributes to read
+     * \throw if the reader has no column cache
+     * \throw if there is no such attribute for the population
+     */
+    void preload(const std::vector<std::string>& names) const;
+
+    /**
+     * Remove all attributes of the population from the column cache of the reader
+     */
+    void evict() const;
+
   protected:
     Population(const std::string& h5FilePath,
                const std::string& csvFilePath,
@@ -187,6 +258,10 @@ template <>
 std::vector<std::string> Population::getAttribute<std::string>(const std::string& name,
                                                                const Selection& selection) const;
 
+template <>
+std::vector<std::vector<std::string>> Population::getAttributes<std::string>(
+    const std::vector<std::string>& names, const Selection& selection) const;
+
 //--------------------------------------------------------------------------------------------------
 
 /**
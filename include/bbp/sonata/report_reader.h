@@ -168,13 +168,17 @@ class SONATA_API ReportReader
          * tstop=nonstd::nullopt indicates no limit. \param tstride indicates every how many
          * timesteps we read data. tstride=nonstd::nullopt indicates that all timesteps are read.
          * \param block_gap_limit gap limit between each IO block while fetching data from storage.
+         * \param prefetch_depth number of IO blocks read ahead, in a background thread, of the
+         * block whose values are being copied. prefetch_depth=nonstd::nullopt or 0 reads
+         * and copies one block after the other.
          */
         DataFrame<KeyType> get(
             const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
             const nonstd::optional<double>& tstart = nonstd::nullopt,
             const nonstd::optional<double>& tstop = nonstd::nullopt,
             const nonstd::optional<size_t>& tstride = nonstd::nullopt,
-            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt) const;
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+            const nonstd::optional<size_t>& prefetch_depth = nonstd::nullopt) const;
 
       private:
         struct NodeIdElementLayout {
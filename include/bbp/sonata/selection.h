@@ -2,8 +2,11 @@
 
 #include "common.h"
 
+#include <algorithm>  // std::min
+#include <cstddef>
 #include <cstdint>
-#include <utility>  // std::move
+#include <iterator>  // std::forward_iterator_tag
+#include <utility>   // std::move
 #include <vector>
 
 namespace bbp {
@@ -17,12 +20,120 @@ class SONATA_API Selection
     using Range = std::array<Value, 2>;
     using Ranges = std::vector<Range>;
 
+    /**
+     * Forward iterator over the IDs of a Selection
+     *
+     * The IDs are visited in the order of the ranges, without materializing
+     * them, see `flatten()`.
+     */
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Value*;
+        using reference = Value;
+
+        const_iterator() = default;
+        const_iterator(const Range* range, const Range* last)
+            : range_(range)
+            , last_(last)
+            , value_(range != last ? std::get<0>(*range) : 0) {}
+
+        Value operator*() const {
+            return value_;
+        }
+
+        const_iterator& operator++() {
+            if (++value_ == std::get<1>(*range_)) {
+                ++range_;
+                value_ = range_ != last_ ? std::get<0>(*range_) : 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return range_ == other.range_ && value_ == other.value_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+        /**
+         * Copy the next (up to) `count` IDs into `out` and advance past them
+         *
+         * Returns the number of IDs copied, which is less than `count` only
+         * if the end of the Selection was reached.
+         */
+        size_t fill(Value* out, size_t count) {
+            size_t n = 0;
+            while (n < count && range_ != last_) {
+                const auto end = std::get<1>(*range_);
+                const auto k = std::min(static_cast<size_t>(end - value_), count - n);
+                for (size_t i = 0; i < k; ++i) {
+                    out[n++] = value_++;
+                }
+                if (value_ == end) {
+                    ++range_;
+                    value_ = range_ != last_ ? std::get<0>(*range_) : 0;
+                }
+            }
+            return n;
+        }
+
+      private:
+        const Range* range_ = nullptr;
+        const Range* last_ = nullptr;
+        Value value_ = 0;
+    };
+
     Selection(Ranges ranges);
 
     template <typename Iterator>
     static Selection fromValues(Iterator first, Iterator last);
     static Selection fromValues(const Values& values);
 
+    /**
+     * Selection from the IDs in `[first, last)`
+     *
+     * Consecutive IDs are detected a block at a time, which is considerably
+     * faster for large arrays with long runs. If `n_threads > 1`, the values
+     * are split into chunks that are processed concurrently and the runs are
+     * joined at the chunk borders. The result is identical to the generic
+     * `fromValues`.
+     */
+    static Selection fromValues(const Value* first, const Value* last, size_t n_threads = 1);
+
+    /**
+     * Selection of the indices `i` in `[0, n)` for which `mask[i]` is non-zero
+     */
+    static Selection fromMask(const uint8_t* mask, size_t n);
+    static Selection fromMask(const bool* mask, size_t n);
+
+    /**
+     * Union of all `selections`, computed in a single k-way merge
+     *
+     * Equivalent to folding `operator|` over `selections`, but runs in
+     * O(N log k) for N ranges in k Selections.
+     */
+    static Selection unionAll(const std::vector<Selection>& selections);
+
+    /**
+     * Intersection of all `selections`, computed in a single k-way merge
+     *
+     * Equivalent to folding `operator&` over `selections`; the intersection
+     * of no Selections is empty.
+     */
+    static Selection intersectAll(const std::vector<Selection>& selections);
+
     /**
      * Get a list of ranges constituting Selection
      */
@@ -33,6 +144,20 @@ class SONATA_API Selection
      */
     Values flatten() const;
 
+    /**
+     * Iterator to the first ID of the Selection
+     */
+    const_iterator begin() const {
+        return {ranges_.data(), ranges_.data() + ranges_.size()};
+    }
+
+    /**
+     * Iterator past the last ID of the Selection
+     */
+    const_iterator end() const {
+        return {ranges_.data() + ranges_.size(), ranges_.data() + ranges_.size()};
+    }
+
     /**
      * Total number of elements constituting Selection
      */
@@ -40,16 +165,84 @@ class SONATA_API Selection
 
     bool empty() const;
 
+    /**
+     * True if the ranges are sorted and non-overlapping
+     *
+     * This is computed once on construction. Set operations on canonical
+     * Selections run in linear time in the number of ranges.
+     */
+    bool isCanonical() const;
+
+    /**
+     * Compact binary representation of the Selection
+     *
+     * Range bounds are stored as variable-length deltas; dense regions of
+     * short ranges are stored as bitmaps. The order of the ranges is
+     * preserved, i.e. `deserialize(s.serialize()) == s`.
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /**
+     * Selection from the output of `serialize`
+     *
+     * Throws a SonataError if `buffer` is malformed.
+     */
+    static Selection deserialize(const std::vector<uint8_t>& buffer);
+
+    /**
+     * Split the Selection into `n_parts` canonical Selections of nearly equal `flatSize`
+     *
+     * The parts are consecutive, i.e. all IDs of part `i` are smaller than
+     * those of part `i + 1`, and their union is the Selection. Parts may be
+     * empty if there are fewer IDs than parts.
+     */
+    std::vector<Selection> partition(size_t n_parts) const;
+
+    /**
+     * Split the Selection into `n_parts` parts of nearly equal read cost
+     *
+     * As `partition`, but balances the number of elements that are read
+     * when the ranges are merged as in `bulk_read::sortAndMerge` with
+     * `min_gap_size` and `max_aggregated_block_size`, i.e. including the
+     * gaps that are read and later discarded.
+     */
+    std::vector<Selection> partitionByReadCost(size_t n_parts,
+                                               size_t min_gap_size,
+                                               size_t max_aggregated_block_size = size_t(-1)) const;
+
   private:
     Ranges ranges_;
+    bool canonical_ = true;
 };
 
 bool SONATA_API operator==(const Selection&, const Selection&);
 bool SONATA_API operator!=(const Selection&, const Selection&);
 
+/**
+ * Intersection, i.e. the IDs contained in both Selections
+ */
 Selection SONATA_API operator&(const Selection&, const Selection&);
+
+/**
+ * Union, i.e. the IDs contained in either Selection
+ */
 Selection SONATA_API operator|(const Selection&, const Selection&);
 
+/**
+ * Difference, i.e. the IDs of the first Selection not contained in the second
+ */
+Selection SONATA_API operator-(const Selection&, const Selection&);
+
+/**
+ * Symmetric difference, i.e. the IDs contained in exactly one of the Selections
+ */
+Selection SONATA_API operator^(const Selection&, const Selection&);
+
+/**
+ * IDs in `[0, size)` not contained in `selection`
+ */
+Selection SONATA_API complement(const Selection& selection, Selection::Value size);
+
 template <typename Iterator>
 Selection Selection::fromValues(Iterator first, Iterator last) {
     Selection::Ranges ranges;
@@ -17,6 +17,7 @@
 #include <fmt/ranges.h>
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -83,6 +84,89 @@ py::object getAttributeVector(const Population& obj,
 }
 
 
+// Reads the `names`, all of dtype `T`, with a single `getAttributes` call
+template <typename T>
+void getAttributes(const Population& obj,
+                   const std::vector<std::string>& names,
+                   const Selection& selection,
+                   py::dict& result) {
+    auto columns = obj.getAttributes<T>(names, selection);
+    for (size_t i = 0; i < names.size(); ++i) {
+        result[py::str(names[i])] = asArray(std::move(columns[i]));
+    }
+}
+
+
+template <typename T>
+py::object getAttributeInto(const Population& obj,
+                            const std::string& name,
+                            const Selection& selection,
+                            py::array out) {
+    if (!py::isinstance<py::array_t<T>>(out)) {
+        throw SonataError(fmt::format("Attribute '{}' needs an output array of dtype {}",
+                                      name,
+                                      std::string(py::str(py::dtype::of<T>()))));
+    }
+    if (out.ndim() != 1 || static_cast<size_t>(out.size()) != selection.flatSize()) {
+        throw SonataError(fmt::format("The output array must be one-dimensional of size {}",
+                                      selection.flatSize()));
+    }
+    if (!out.writeable() || !(out.flags() & py::array::c_style)) {
+        throw SonataError("The output array must be writeable and contiguous");
+    }
+
+    obj.getAttributeInto<T>(name, selection, static_cast<T*>(out.mutable_data()));
+    return std::move(out);
+}
+
+
+template <>
+py::object getAttributeInto<std::string>(const Population&,
+                                         const std::string& name,
+                                         const Selection&,
+                                         py::array) {
+    throw SonataError(
+        fmt::format("Attribute '{}': only numeric attributes can be read into an array", name));
+}
+
+
+// A read-only view of the mapped values if possible, otherwise a read-only copy
+template <typename T>
+py::object getAttributeView(const Population& obj,
+                            const std::string& name,
+                            const Selection& selection) {
+    const auto& ranges = selection.ranges();
+    std::shared_ptr<const T> view;
+    if (ranges.size() == 1) {
+        view = obj.getAttributeView<T>(name, ranges[0]);
+    }
+
+    py::array result;
+    if (view != nullptr) {
+        auto owner = new std::shared_ptr<const T>(view);
+        result = py::array(py::dtype::of<T>(),
+                           {selection.flatSize()},
+                           {sizeof(T)},
+                           view.get(),
+                           freeWhenDone(owner));
+    } else {
+        result = asArray(obj.getAttribute<T>(name, selection));
+    }
+    result.attr("flags").attr("writeable") = false;
+    return std::move(result);
+}
+
+
+template <>
+py::object getAttributeView<std::string>(const Population& obj,
+                                         const std::string& name,
+                                         const Selection& selection) {
+    py::array result = asArray(obj.getAttribute<std::string>(name, selection));
+    result.attr("flags").attr("writeable") = false;
+    return std::move(result);
+}
+
+
 template <typename T>
 py::object getEnumerationVector(const Population& obj,
                                 const std::string& name,
@@ -232,6 +316,58 @@ py::class_<Population, std::shared_ptr<Population>> bindPopulationClass(py::modu
             "selection"_a,
             "default_value"_a,
             imbueElementName(DOC_POP(getAttribute)).c_str())
+        .def(
+            "get_attributes",
+            [](Population& obj, const std::vector<std::string>& names, const Selection& selection) {
+                std::map<std::string, std::vector<std::string>> names_by_dtype;
+                for (const auto& name : names) {
+                    names_by_dtype[obj._attributeDataType(name, true)].push_back(name);
+                }
+
+                py::dict columns;
+                for (const auto& it : names_by_dtype) {
+                    [&]() {
+                        DISPATCH_TYPE(it.first, getAttributes, obj, it.second, selection, columns);
+                    }();
+                }
+
+                py::dict result;
+                for (const auto& name : names) {
+                    result[py::str(name)] = columns[py::str(name)];
+                }
+                return result;
+            },
+            "names"_a,
+            "selection"_a,
+            imbueElementName(DOC_POP(getAttributes)).c_str())
+        .def(
+            "get_attribute_into",
+            [](Population& obj,
+               const std::string& name,
+               const Selection& selection,
+               py::array out) {
+                const auto dtype = obj._attributeDataType(name, false);
+                DISPATCH_TYPE(dtype, getAttributeInto, obj, name, selection, out);
+            },
+            "name"_a,
+            "selection"_a,
+            "out"_a,
+            imbueElementName(DOC_POP(getAttributeInto)).c_str())
+        .def(
+            "get_attribute_view",
+            [](Population& obj, const std::string& name, const Selection& selection) {
+                const auto dtype = obj._attributeDataType(name, true);
+                DISPATCH_TYPE(dtype, getAttributeView, obj, name, selection);
+            },
+            "name"_a,
+            "selection"_a,
+            imbueElementName(
+                "Read-only attribute values for given {element} Selection.\n\n"
+                "If the Selection is a single range and the population was opened with\n"
+                "``Hdf5ReaderOptions.memory_map``, the values are not copied, but viewed\n"
+                "in a memory map of the file, see ``Hdf5ReaderOptions.memory_map``.\n"
+                "Otherwise, the values are read as by ``get_attribute``.")
+                .c_str())
         .def_property_readonly("dynamics_attribute_names",
                                &Population::dynamicsAttributeNames,
                                DOC_POP(dynamicsAttributeNames))
@@ -294,7 +430,9 @@ py::class_<Population, std::shared_ptr<Population>> bindPopulationClass(py::modu
             },
             "name"_a,
             "selection"_a,
-            imbueElementName(DOC_POP(enumerationValues)).c_str());
+            imbueElementName(DOC_POP(enumerationValues)).c_str())
+        .def("preload", &Population::preload, "names"_a, DOC_POP(preload))
+        .def("evict", &Population::evict, DOC_POP(evict));
 }
 
 
@@ -371,7 +509,8 @@ void bindReportReader(py::module& m, const std::string& prefix) {
              "tstart"_a = nonstd::nullopt,
              "tstop"_a = nonstd::nullopt,
              "tstride"_a = nonstd::nullopt,
-             "block_gap_limit"_a = nonstd::nullopt)
+             "block_gap_limit"_a = nonstd::nullopt,
+             "prefetch_depth"_a = nonstd::nullopt)
         .def("get_node_ids",
              &ReportType::Population::getNodeIds,
              "Return the list of nodes ids for this population")
@@ -406,7 +545,139 @@ void bindReportReader(py::module& m, const std::string& prefix) {
 
 
 PYBIND11_MODULE(_libsonata, m) {
-    py::class_<Hdf5Reader>(m, "Hdf5Reader").def(py::init([]() { return Hdf5Reader(); }));
+    py::class_<Hdf5DatasetStatistics>(m,
+                                      "Hdf5DatasetStatistics",
+                                      DOC(bbp, sonata, Hdf5DatasetStatistics))
+        .def_readonly("n_read_calls",
+                      &Hdf5DatasetStatistics::n_read_calls,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, n_read_calls))
+        .def_readonly("n_elements_requested",
+                      &Hdf5DatasetStatistics::n_elements_requested,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, n_elements_requested))
+        .def_readonly("n_elements_read",
+                      &Hdf5DatasetStatistics::n_elements_read,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, n_elements_read))
+        .def_readonly("n_canonicalizations",
+                      &Hdf5DatasetStatistics::n_canonicalizations,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, n_canonicalizations))
+        .def_readonly("read_seconds",
+                      &Hdf5DatasetStatistics::read_seconds,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, read_seconds))
+        .def_readonly("latency_histogram",
+                      &Hdf5DatasetStatistics::latency_histogram,
+                      DOC(bbp, sonata, Hdf5DatasetStatistics, latency_histogram));
+
+    py::class_<Hdf5ReaderStatistics, std::shared_ptr<Hdf5ReaderStatistics>>(
+        m, "Hdf5ReaderStatistics", DOC(bbp, sonata, Hdf5ReaderStatistics))
+        .def(py::init<>())
+        .def("snapshot",
+             &Hdf5ReaderStatistics::snapshot,
+             DOC(bbp, sonata, Hdf5ReaderStatistics, snapshot))
+        .def("reset", &Hdf5ReaderStatistics::reset, DOC(bbp, sonata, Hdf5ReaderStatistics, reset));
+
+    py::class_<Hdf5BlockCache, std::shared_ptr<Hdf5BlockCache>>(m,
+                                                                "Hdf5BlockCache",
+                                                                DOC(bbp, sonata, Hdf5BlockCache))
+        .def(py::init<size_t, size_t>(),
+             "max_bytes"_a,
+             "block_bytes"_a = size_t(1) << 20,
+             DOC(bbp, sonata, Hdf5BlockCache, Hdf5BlockCache))
+        .def_property_readonly("max_bytes", &Hdf5BlockCache::maxBytes)
+        .def_property_readonly("block_bytes", &Hdf5BlockCache::blockBytes)
+        .def_property_readonly("bytes",
+                               &Hdf5BlockCache::bytes,
+                               DOC(bbp, sonata, Hdf5BlockCache, bytes))
+        .def_property_readonly("hits",
+                               &Hdf5BlockCache::hits,
+                               DOC(bbp, sonata, Hdf5BlockCache, hits))
+        .def_property_readonly("misses",
+                               &Hdf5BlockCache::misses,
+                               DOC(bbp, sonata, Hdf5BlockCache, misses))
+        .def("clear", &Hdf5BlockCache::clear, DOC(bbp, sonata, Hdf5BlockCache, clear));
+
+    py::class_<Hdf5ColumnCache, std::shared_ptr<Hdf5ColumnCache>>(
+        m, "Hdf5ColumnCache", DOC(bbp, sonata, Hdf5ColumnCache))
+        .def(py::init<size_t>(),
+             "max_bytes"_a,
+             DOC(bbp, sonata, Hdf5ColumnCache, Hdf5ColumnCache))
+        .def_property_readonly("max_bytes", &Hdf5ColumnCache::maxBytes)
+        .def_property_readonly("bytes",
+                               &Hdf5ColumnCache::bytes,
+                               DOC(bbp, sonata, Hdf5ColumnCache, bytes))
+        .def_property_readonly("hits",
+                               &Hdf5ColumnCache::hits,
+                               DOC(bbp, sonata, Hdf5ColumnCache, hits))
+        .def_property_readonly("misses",
+                               &Hdf5ColumnCache::misses,
+                               DOC(bbp, sonata, Hdf5ColumnCache, misses))
+        .def("clear", &Hdf5ColumnCache::clear, DOC(bbp, sonata, Hdf5ColumnCache, clear));
+
+    py::class_<Hdf5ReaderOptions> hdf5ReaderOptions(m,
+                                                    "Hdf5ReaderOptions",
+                                                    DOC(bbp, sonata, Hdf5ReaderOptions));
+
+    py::enum_<Hdf5ReaderOptions::ReadMode>(hdf5ReaderOptions, "ReadMode")
+        .value("automatic", Hdf5ReaderOptions::ReadMode::automatic)
+        .value("merge", Hdf5ReaderOptions::ReadMode::merge)
+        .value("hyperslab", Hdf5ReaderOptions::ReadMode::hyperslab);
+
+    // `global` is a Python keyword
+    py::enum_<Hdf5ReaderOptions::Locking>(hdf5ReaderOptions, "Locking")
+        .value("automatic", Hdf5ReaderOptions::Locking::automatic)
+        .value("global_", Hdf5ReaderOptions::Locking::global)
+        .value("per_file", Hdf5ReaderOptions::Locking::per_file)
+        .value("none", Hdf5ReaderOptions::Locking::none);
+
+    hdf5ReaderOptions.def(py::init<>())
+        .def_readwrite("read_mode",
+                       &Hdf5ReaderOptions::read_mode,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, read_mode))
+        .def_readwrite("min_gap_bytes",
+                       &Hdf5ReaderOptions::min_gap_bytes,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, min_gap_bytes))
+        .def_readwrite("max_aggregated_block_bytes",
+                       &Hdf5ReaderOptions::max_aggregated_block_bytes,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, max_aggregated_block_bytes))
+        .def_readwrite("max_aggregated_block_bytes_2d",
+                       &Hdf5ReaderOptions::max_aggregated_block_bytes_2d,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, max_aggregated_block_bytes_2d))
+        .def_readwrite("chunk_aware",
+                       &Hdf5ReaderOptions::chunk_aware,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, chunk_aware))
+        .def_readwrite("n_reader_threads",
+                       &Hdf5ReaderOptions::n_reader_threads,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, n_reader_threads))
+        .def_readwrite("prefetch_depth",
+                       &Hdf5ReaderOptions::prefetch_depth,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, prefetch_depth))
+        .def_readwrite("n_decompression_threads",
+                       &Hdf5ReaderOptions::n_decompression_threads,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, n_decompression_threads))
+        .def_readwrite("statistics",
+                       &Hdf5ReaderOptions::statistics,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, statistics))
+        .def_readwrite("block_cache",
+                       &Hdf5ReaderOptions::block_cache,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, block_cache))
+        .def_readwrite("column_cache",
+                       &Hdf5ReaderOptions::column_cache,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, column_cache))
+        .def_readwrite("memory_map",
+                       &Hdf5ReaderOptions::memory_map,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, memory_map))
+        .def_readwrite("io_uring_queue_depth",
+                       &Hdf5ReaderOptions::io_uring_queue_depth,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, io_uring_queue_depth))
+        .def_readwrite("locking",
+                       &Hdf5ReaderOptions::locking,
+                       DOC(bbp, sonata, Hdf5ReaderOptions, locking));
+
+    py::class_<Hdf5Reader>(m, "Hdf5Reader")
+        .def(py::init([]() { return Hdf5Reader(); }))
+        .def(py::init<const Hdf5ReaderOptions&>(), "options"_a)
+        .def_property_readonly("options",
+                               &Hdf5Reader::options,
+                               DOC(bbp, sonata, Hdf5Reader, options));
 
     py::class_<Selection>(m,
                           "Selection",
@@ -446,10 +717,20 @@ PYBIND11_MODULE(_libsonata, m) {
                      }
                  }
 
-                 return Selection::fromValues(raw.data(0), raw.data(raw.shape(0)));
+                 // all values are non-negative, hence have the same representation as uint64_t
+                 const auto* data = reinterpret_cast<const Selection::Value*>(raw.data(0));
+                 return Selection::fromValues(data, data + raw.shape(0));
              }),
              "values"_a,
              "Selection from list of IDs: passing np.array with dtype np.uint64 is faster")
+        .def_static(
+            "from_mask",
+            [](py::array_t<bool, py::array::c_style | py::array::forcecast> mask) {
+                const auto raw = mask.unchecked<1>();
+                return Selection::fromMask(raw.data(0), raw.shape(0));
+            },
+            "mask"_a,
+            DOC_SEL(fromMask))
         .def_property_readonly(
             "ranges",
             [](const Selection& obj) {
@@ -470,10 +751,48 @@ PYBIND11_MODULE(_libsonata, m) {
             "__bool__",
             [](const Selection& obj) { return !obj.empty(); },
             "True if Selection is not empty")
+        .def(
+            "serialize",
+            [](const Selection& obj) {
+                const auto buffer = obj.serialize();
+                return py::bytes(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            },
+            DOC_SEL(serialize))
+        .def_static(
+            "deserialize",
+            [](const py::bytes& buffer) {
+                const auto data = static_cast<std::string>(buffer);
+                return Selection::deserialize({data.begin(), data.end()});
+            },
+            "buffer"_a,
+            DOC_SEL(deserialize))
+        .def("partition", &Selection::partition, "n_parts"_a, DOC_SEL(partition))
+        .def("partition_by_read_cost",
+             &Selection::partitionByReadCost,
+             "n_parts"_a,
+             "min_gap_size"_a,
+             "max_aggregated_block_size"_a = size_t(-1),
+             DOC_SEL(partitionByReadCost))
+        .def(py::pickle(
+            [](const Selection& obj) {
+                const auto buffer = obj.serialize();
+                return py::bytes(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            },
+            [](const py::bytes& state) {
+                const auto data = static_cast<std::string>(state);
+                return Selection::deserialize({data.begin(), data.end()});
+            }))
         .def("__eq__", &bbp::sonata::operator==, "Compare selection contents are equal")
         .def("__ne__", &bbp::sonata::operator!=, "Compare selection contents are not equal")
         .def("__or__", &bbp::sonata::operator|, "Union of selections")
         .def("__and__", &bbp::sonata::operator&, "Intersection of selections")
+        .def("__sub__", &bbp::sonata::operator-, "Difference of selections")
+        .def("__xor__", &bbp::sonata::operator^, "Symmetric difference of selections")
+        .def(
+            "complement",
+            [](const Selection& obj, Selection::Value size) { return complement(obj, size); },
+            "size"_a,
+            DOC(bbp, sonata, complement))
         .def("__repr__", [](Selection& obj) {
             const auto& ranges = obj.ranges();
             const size_t max_count = 10;
@@ -1248,6 +1567,7 @@ PYBIND11_MODULE(_libsonata, m) {
                     "source_node_count"_a,
                     "target_node_count"_a,
                     "overwrite"_a = false,
+                    "hdf5_reader"_a = Hdf5Reader(),
                     DOC_POP_EDGE(writeIndices));
 
     bindStorageClass<EdgeStorage>(m, "EdgeStorage", "EdgePopulation");
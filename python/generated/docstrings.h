@@ -165,6 +165,48 @@ R"doc(Path to underlying types csv file. It is discouraged to directly
 access the contents of the file. Instead use 'libsonata' to read this
 file.)doc";
 
+static const char *__doc_bbp_sonata_CompressedSelection =
+R"doc(Compressed representation of a set of IDs.
+
+The IDs are split into blocks of 2^16 consecutive values. Each block
+is stored either as an array, a list of runs or a bitmap, whichever is
+smallest. This keeps sparse selections, e.g. thousands of isolated
+IDs, compact while set operations run in linear time in the number of
+blocks and, for dense blocks, operate on whole 64-bit words.
+
+Unlike `Selection`, a CompressedSelection is a set: the order of the
+ranges it was created from, and any overlap between them, is not
+retained. Hence, `ranges()` is always canonical, i.e. sorted, non-
+overlapping and without touching ranges.)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_CompressedSelection = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_CompressedSelection_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_CompressedSelection_3 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_CompressedSelection_4 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_blocks = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_blocks_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_contains = R"doc(True if `value` is part of the CompressedSelection)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_empty = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_flatSize = R"doc(Total number of elements constituting the CompressedSelection)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_flatten = R"doc(Sorted array of IDs constituting the CompressedSelection)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_fromValues = R"doc()doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_memoryUsage = R"doc(Approximate number of bytes used to store the IDs)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_ranges = R"doc(Get the canonical list of ranges constituting the CompressedSelection)doc";
+
+static const char *__doc_bbp_sonata_CompressedSelection_toSelection = R"doc(Convert to a canonical `Selection`)doc";
+
 static const char *__doc_bbp_sonata_DataFrame = R"doc()doc";
 
 static const char *__doc_bbp_sonata_DataFrame_data = R"doc()doc";
@@ -201,7 +243,155 @@ static const char *__doc_bbp_sonata_EdgePopulation_target = R"doc(Name of target
 
 static const char *__doc_bbp_sonata_EdgePopulation_targetNodeIDs = R"doc(Return target node IDs for a given edge selection)doc";
 
-static const char *__doc_bbp_sonata_EdgePopulation_writeIndices = R"doc(Write bidirectional node->edge indices to EdgePopulation HDF5.)doc";
+static const char *__doc_bbp_sonata_EdgePopulation_writeIndices =
+R"doc(Write bidirectional node->edge indices to EdgePopulation HDF5.
+
+Takes the same lock as the populations read from the file with
+`hdf5_reader`, see `Hdf5ReaderOptions::locking`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache =
+R"doc(Memory-bounded LRU cache of blocks read by the default `Hdf5Reader`
+plugin.
+
+One-dimensional datasets are split into aligned blocks of
+`block_bytes` bytes. If a cache is attached via
+`Hdf5ReaderOptions::block_cache`, selections are read by whole blocks,
+and blocks read before are taken from the cache instead of the file.
+This helps when the same or nearby selections are read repeatedly,
+e.g. in interactive analysis.
+
+Blocks are identified by the name of the file, the path of the dataset
+and the type they were read as; the cache must be cleared if a file is
+modified. The cache is thread-safe and can be shared by several
+readers.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Hdf5BlockCache =
+R"doc(A cache holding at most `max_bytes` bytes of blocks of `block_bytes`
+bytes.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Hdf5BlockCache_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key = R"doc(Identifies one block of a dataset.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key_begin = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key_dataset = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key_end = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key_file = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_Key_type = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_blockBytes = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_bytes = R"doc(Number of bytes of the blocks currently cached.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_clear = R"doc(Remove all blocks; the counters are not reset.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_find =
+R"doc(The block `key`, or `nullptr` if it isn't cached. Counts a hit or
+miss.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_hits = R"doc(Number of blocks found in the cache.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_impl_ = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_insert =
+R"doc(Add the block `key`, of `bytes` bytes, evicting the least recently
+used blocks.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_maxBytes = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_misses = R"doc(Number of blocks which had to be read from the file.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5BlockCache_operator_assign = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache =
+R"doc(Memory-bounded LRU cache of whole attribute columns of a `Population`.
+
+If a cache is attached via `Hdf5ReaderOptions::column_cache`, the
+first read of an attribute reads all its values and keeps them in the
+cache; later reads, of any selection, are served from memory. This
+suits repeatedly filtering or matching the same attributes, e.g. when
+materializing node sets. Columns which don't fit in the cache are read
+from the file as usual.
+
+Columns are identified by the name of the file, the path of the
+dataset and the type they were read as; the cache must be cleared if a
+file is modified. The cache is thread-safe and can be shared by
+several readers, so that all their populations share one memory
+budget.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Hdf5ColumnCache = R"doc(A cache holding at most `max_bytes` bytes of columns.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Hdf5ColumnCache_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Key = R"doc(Identifies one column.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Key_dataset = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Key_file = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_Key_type = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_bytes = R"doc(Number of bytes of the columns currently cached.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_clear =
+R"doc(Remove all columns, and forget which ones are too large; the counters
+are not reset.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_erase =
+R"doc(Remove the columns of the dataset `dataset` of `file`, read as any
+type, and forget whether they were too large.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_find =
+R"doc(The column `key`, or `nullptr` if it isn't cached. Counts a hit or
+miss.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_hits = R"doc(Number of columns found in the cache.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_impl_ = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_insert =
+R"doc(Add the column `key`, of `bytes` bytes, evicting the least recently
+used columns.
+
+Returns `false`, without caching it, if the column is larger than the
+whole cache; the column is then remembered as too large.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_isTooLarge = R"doc(Was the column `key` found too large to be cached by `insert`?)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_maxBytes = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_misses = R"doc(Number of columns which had to be read from the file.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ColumnCache_operator_assign = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics = R"doc(I/O statistics of one dataset, see `Hdf5ReaderStatistics`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_latency_histogram =
+R"doc(Histogram of the wall time per HDF5 read call.
+
+Bucket `0` counts the calls shorter than 1 microsecond, bucket `i` the
+calls taking from `2^(i-1)` up to `2^i` microseconds. The last bucket
+also counts all longer calls.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_n_canonicalizations =
+R"doc(Number of selections which were not canonical and had to be sorted and
+merged before reading.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_n_elements_read =
+R"doc(Number of elements read from the dataset, including the gaps between
+ranges which were merged into one block.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_n_elements_requested = R"doc(Number of elements of the selections passed to the reader.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_n_latency_buckets = R"doc(Number of buckets of `latency_histogram`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_n_read_calls = R"doc(Number of HDF5 read calls.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5DatasetStatistics_read_seconds = R"doc(Total wall time spent in HDF5 read calls, in seconds.)doc";
 
 static const char *__doc_bbp_sonata_Hdf5PluginInterface = R"doc()doc";
 
@@ -214,6 +404,13 @@ The selection is canonical, i.e. sorted and non-overlapping. The
 dataset is obtained from a `HighFive::File` opened via
 `this->openFile`.)doc";
 
+static const char *__doc_bbp_sonata_Hdf5PluginRead1DInterface_readSelectionInto =
+R"doc(Read the selected subset of the one-dimensional array into `out`.
+
+Same as `readSelection`, but writes the values to `out`, which must
+have room for `selection.flatSize()` values. The default
+implementation copies the result of `readSelection`.)doc";
+
 static const char *__doc_bbp_sonata_Hdf5PluginRead2DInterface = R"doc()doc";
 
 static const char *__doc_bbp_sonata_Hdf5PluginRead2DInterface_readSelection =
@@ -221,7 +418,13 @@ R"doc(Read the Cartesian product of the two selections.
 
 Both selections are canonical, i.e. sorted and non-overlapping. The
 dataset is obtained from a `HighFive::File` opened via
-`this->openFile`.)doc";
+`this->openFile`.
+
+The values are returned in row-major order. If `T` is an `std::array`,
+each element holds that many consecutive values of one row.
+
+Optional for plugins; the default implementation throws a
+`SonataError`.)doc";
 
 static const char *__doc_bbp_sonata_Hdf5Reader =
 R"doc(Abstraction for reading HDF5 datasets.
@@ -270,7 +473,11 @@ selection); } else { hdf5_reader.readSelection(dset, {}); } })doc";
 
 static const char *__doc_bbp_sonata_Hdf5Reader_Hdf5Reader = R"doc(Create a valid Hdf5Reader with the default plugin.)doc";
 
-static const char *__doc_bbp_sonata_Hdf5Reader_Hdf5Reader_2 = R"doc(Create an Hdf5Reader with a user supplied plugin.)doc";
+static const char *__doc_bbp_sonata_Hdf5Reader_Hdf5Reader_2 =
+R"doc(Create a valid Hdf5Reader with the default plugin configured by
+`options`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5Reader_Hdf5Reader_3 = R"doc(Create an Hdf5Reader with a user supplied plugin.)doc";
 
 static const char *__doc_bbp_sonata_Hdf5Reader_impl = R"doc()doc";
 
@@ -280,6 +487,13 @@ R"doc(Open the HDF5.
 The dataset passed to `readSelection` must be obtained from a file
 open via this method.)doc";
 
+static const char *__doc_bbp_sonata_Hdf5Reader_options =
+R"doc(The options of the default plugin.
+
+User supplied plugins are not affected by them.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5Reader_options_ = R"doc()doc";
+
 static const char *__doc_bbp_sonata_Hdf5Reader_readSelection =
 R"doc(Read the selected subset of the one-dimensional array.
 
@@ -292,7 +506,175 @@ R"doc(Read the Cartesian product of the two selections.
 
 Both selections are canonical, i.e. sorted and non-overlapping. The
 dataset is obtained from a `HighFive::File` opened via
-`this->openFile`.)doc";
+`this->openFile`.
+
+The values are returned in row-major order. If `T` is an
+`std::array`, each element holds that many consecutive values of one
+row.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5Reader_readSelectionInto =
+R"doc(Read the selected subset of the one-dimensional array into `out`.
+
+Same as `readSelection`, but writes the values to `out`, which must
+have room for `selection.flatSize()` values.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions =
+R"doc(Options of the default `Hdf5Reader` plugin.
+
+Canonical selections are read with a merge-read-extract algorithm:
+ranges separated by small gaps are merged into larger blocks, each
+block is read with a single HDF5 call, and the requested values are
+then extracted from it. These options control how ranges are merged.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_Locking = R"doc(How libsonata keeps threads from using HDF5 at the same time.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_Locking_automatic = R"doc(`none` if HDF5 was built thread-safe, `global` otherwise.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_Locking_global = R"doc(All threads take turns, for all files.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_Locking_none = R"doc(No lock is taken by libsonata; HDF5 serializes its calls itself.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_Locking_per_file =
+R"doc(Threads take turns per file, so that different files, e.g. nodes and
+edges, can be read at the same time.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_ReadMode = R"doc(How a canonical selection of a one-dimensional dataset is read.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_ReadMode_automatic =
+R"doc(Choose between `merge` and `hyperslab` based on the number of ranges,
+and on how many unneeded values merging would read. The thresholds
+were measured on a local file. Chunked datasets read by whole chunks,
+see `chunk_aware`, are always merged.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_ReadMode_hyperslab =
+R"doc(Read the union of all ranges with a single HDF5 call, leaving the
+gather to HDF5.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_ReadMode_merge =
+R"doc(Merge ranges into blocks, read one block per HDF5 call and extract the
+requested values.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_block_cache =
+R"doc(If set, one-dimensional datasets are read by whole blocks, which are
+kept in this cache. Selections are then never read as a hyperslab.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_chunk_aware =
+R"doc(Take the chunk layout of chunked datasets into account.
+
+HDF5 reads, and decompresses, chunked datasets one chunk at a time. If
+enabled, the thresholds above are rounded to whole chunks, gaps within
+compressed datasets are only merged if no unneeded chunk is read, and
+blocks that share a chunk are merged, so that each chunk is read once.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_column_cache =
+R"doc(If set, attributes of a `Population` are read as whole columns, which
+are kept in this cache, see `Hdf5ColumnCache`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_io_uring_queue_depth =
+R"doc(If non-zero, read contiguous datasets with Linux io_uring, keeping up
+to this many reads in flight.
+
+The merged blocks of a selection are located in the file and all
+submitted at once, rather than read one at a time through HDF5. As
+these reads are cheap, ranges are only merged across gaps of up to a
+page. Applies to the same datasets as `memory_map`, which takes
+precedence; all other datasets, and all datasets on systems without
+io_uring, are read as usual.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_locking =
+R"doc(The locking strategy of the populations read with this reader.
+
+The lock is only held for the HDF5 calls themselves, not while values
+are reordered, taken from a `column_cache`, or enumerations are
+resolved to strings. Neither is it held while ranges are merged,
+values are extracted from blocks or copied from a `block_cache`,
+chunks are decompressed, or values are read from a memory map or with
+io_uring. User supplied plugins are called with the lock held. Unless
+HDF5 was built thread-safe, HDF5 keeps state shared by all files, and
+the global lock is always used.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_max_aggregated_block_bytes =
+R"doc(Blocks of one-dimensional datasets are not extended once they reach
+this many bytes.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_max_aggregated_block_bytes_2d =
+R"doc(Blocks of two-dimensional datasets are not extended once they reach
+this many bytes.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_memory_map =
+R"doc(Read datasets straight from a read-only memory map of the file.
+
+Only applies to numeric datasets with contiguous layout, which are
+hence neither chunked nor compressed, stored in the native byte order
+of the requested type, and to files opened with the default driver.
+These are read without HDF5, by copying the selected values from the
+mapped pages; all other datasets are read as usual. The files must not
+be modified while they are mapped.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_min_gap_bytes = R"doc(Ranges separated by a gap of fewer bytes are read as one block.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_n_decompression_threads =
+R"doc(Number of threads decompressing the chunks of compressed datasets.
+
+If non-zero, one-dimensional datasets compressed with deflate (gzip),
+optionally after shuffle, are read one raw chunk at a time with
+`H5Dread_chunk`, bypassing the filter pipeline of HDF5. This many
+threads, including the calling one, then decompress the chunks in
+parallel, outside of HDF5, and copy the requested values to the
+output. Only applies to datasets stored in the native representation
+of the requested type; all other datasets are read as usual.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_n_reader_threads =
+R"doc(Number of threads reading the merged blocks of one selection.
+
+With more than one thread, blocks are read in the background while the
+calling thread extracts the requested values from the blocks already
+read. HDF5 makes its calls one at a time, even if built threadsafe,
+hence the reads themselves don't overlap; only reading and extracting
+do. Not used for selections read as a hyperslab.
+
+Values of large unsorted or overlapping selections of a `Population`
+are also copied into place by this many threads.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_prefetch_depth =
+R"doc(Number of blocks read ahead of the block being extracted.
+
+If non-zero, blocks are read in the background while the values of the
+previous blocks are extracted; blocks longer than
+`max_aggregated_block_bytes` are split so that even a single large
+range is read in pieces. The default of `0` reads and extracts one
+block after the other. With several `n_reader_threads`, the default
+depth is twice the number of threads.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_read_mode =
+R"doc(The read mode; `merge` unless changed, since a single hyperslab can be
+much slower on fragmented selections.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderOptions_statistics = R"doc(If set, I/O statistics are recorded in this collector.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics =
+R"doc(Collects I/O statistics of the default `Hdf5Reader` plugin, per
+dataset.
+
+Attach a collector via `Hdf5ReaderOptions::statistics`. The same
+collector may be shared by several readers and used from several
+threads. This is meant to tune the merge thresholds of
+`Hdf5ReaderOptions`, e.g. the ratio of `n_elements_read` to
+`n_elements_requested` is the read amplification caused by merging.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_mutex_ = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_recordCanonicalization = R"doc(Record a selection which was canonicalized before reading it.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_recordRead = R"doc(Record one HDF5 read call of `n_elements`, which took `seconds`.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_recordRequest = R"doc(Record a selection of `n_elements` passed to the reader.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_reset = R"doc(Discard all statistics collected so far.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_snapshot = R"doc(A copy of the statistics collected so far.)doc";
+
+static const char *__doc_bbp_sonata_Hdf5ReaderStatistics_statistics_ = R"doc()doc";
 
 static const char *__doc_bbp_sonata_NodePopulation = R"doc()doc";
 
@@ -390,6 +772,73 @@ The duplicate names are returned.)doc";
 
 static const char *__doc_bbp_sonata_Population = R"doc()doc";
 
+static const char *__doc_bbp_sonata_Population_evict =
+R"doc(Remove all attributes of the population from the column cache of the
+reader)doc";
+
+static const char *__doc_bbp_sonata_Population_getAttributeView =
+R"doc(Read-only view of the attribute values of the {element}s in `range`
+
+The values are not copied, but accessed straight in a memory map of
+the file, which the view keeps alive. The map is shared with all reads
+and views of the same reader. This requires a reader with
+`Hdf5ReaderOptions::memory_map`, and an attribute which can be mapped,
+see there.
+
+Parameter ``name``:
+    is a string to allow attributes not defined in spec
+
+Parameter ``range``:
+    is the half-open range of {element}s
+
+Returns:
+    `nullptr` if the attribute can't be mapped as `T`
+
+Throws:
+    if there is no such attribute for the population
+
+Throws:
+    if the range is out of bounds)doc";
+
+static const char *__doc_bbp_sonata_Population_getAttributes =
+R"doc(Get the values of several attributes for the same {element} Selection
+
+Same as calling `getAttribute` for each of the `names`, but the
+selection is prepared only once: if it isn't sorted and free of
+overlaps, the canonical selection read from the file and the order in
+which to return the values are computed once, and reused for every
+attribute.
+
+Parameter ``names``:
+    are the attributes to read, all of which are read as `T`
+
+Parameter ``selection``:
+    is a selection to retrieve the attribute values from
+
+Returns:
+    the values of each attribute, in the order of `names`
+
+Throws:
+    if there is no such attribute for the population)doc";
+
+static const char *__doc_bbp_sonata_Population_preload =
+R"doc(Read attributes into the column cache of the reader
+
+Reads all values of each of the `names`, as the type they are stored
+as, into `Hdf5ReaderOptions::column_cache`, so that later reads, and
+filtering or matching, of these attributes are served from memory. For
+explicit enumerations, the indices and the enumeration values are
+read.
+
+Parameter ``names``:
+    are the attributes to read
+
+Throws:
+    if the reader has no column cache
+
+Throws:
+    if there is no such attribute for the population)doc";
+
 static const char *__doc_bbp_sonata_PopulationStorage = R"doc(Collection of {PopulationClass}s stored in a H5 file and optional CSV.)doc";
 
 static const char *__doc_bbp_sonata_PopulationStorage_Impl = R"doc()doc";
@@ -507,6 +956,25 @@ Parameter ``default``:
 Throws:
     if there is no such attribute for the population)doc";
 
+static const char *__doc_bbp_sonata_Population_getAttributeInto =
+R"doc(Read attribute values for given {element} Selection into `out`
+
+Same as `getAttribute`, but writes the values to `out`, which must
+have room for `selection.flatSize()` values. Only numeric types are
+supported; for explicit enumerations the indices are read.
+
+Parameter ``name``:
+    is a string to allow attributes not defined in spec
+
+Parameter ``selection``:
+    is a selection to retrieve the attribute values from
+
+Parameter ``out``:
+    is where the values are written to
+
+Throws:
+    if there is no such attribute for the population)doc";
+
 static const char *__doc_bbp_sonata_Population_getDynamicsAttribute =
 R"doc(Get dynamics attribute values for given {element} Selection
 
@@ -602,7 +1070,12 @@ Parameter ``tstride``:
     tstride=nonstd::nullopt indicates that all timesteps are read.
 
 Parameter ``block_gap_limit``:
-    gap limit between each IO block while fetching data from storage.)doc";
+    gap limit between each IO block while fetching data from storage.
+
+Parameter ``prefetch_depth``:
+    number of IO blocks read ahead, in a background thread, of the
+    block whose values are being copied. prefetch_depth=nonstd::nullopt
+    or 0 reads and copies one block after the other.)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_getDataUnits = R"doc(Return the unit of data.)doc";
 
@@ -680,20 +1153,117 @@ static const char *__doc_bbp_sonata_Selection = R"doc()doc";
 
 static const char *__doc_bbp_sonata_Selection_Selection = R"doc()doc";
 
+static const char *__doc_bbp_sonata_Selection_begin = R"doc(Iterator to the first ID of the Selection)doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator =
+R"doc(Forward iterator over the IDs of a Selection
+
+The IDs are visited in the order of the ranges, without materializing
+them, see `flatten()`.)doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_const_iterator = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_const_iterator_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_fill =
+R"doc(Copy the next (up to) `count` IDs into `out` and advance past them
+
+Returns the number of IDs copied, which is less than `count` only if
+the end of the Selection was reached.)doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_last = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_operator_eq = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_operator_inc = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_operator_inc_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_operator_mul = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_operator_ne = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_range = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_const_iterator_value = R"doc()doc";
+
+static const char *__doc_bbp_sonata_Selection_deserialize =
+R"doc(Selection from the output of `serialize`
+
+Throws a SonataError if `buffer` is malformed.)doc";
+
 static const char *__doc_bbp_sonata_Selection_empty = R"doc()doc";
 
+static const char *__doc_bbp_sonata_Selection_end = R"doc(Iterator past the last ID of the Selection)doc";
+
 static const char *__doc_bbp_sonata_Selection_flatSize = R"doc(Total number of elements constituting Selection)doc";
 
 static const char *__doc_bbp_sonata_Selection_flatten = R"doc(Array of IDs constituting Selection)doc";
 
+static const char *__doc_bbp_sonata_Selection_fromMask =
+R"doc(Selection of the indices `i` in `[0, n)` for which `mask[i]` is non-
+zero)doc";
+
+static const char *__doc_bbp_sonata_Selection_fromMask_2 = R"doc()doc";
+
 static const char *__doc_bbp_sonata_Selection_fromValues = R"doc()doc";
 
 static const char *__doc_bbp_sonata_Selection_fromValues_2 = R"doc()doc";
 
+static const char *__doc_bbp_sonata_Selection_fromValues_3 =
+R"doc(Selection from the IDs in `[first, last)`
+
+Consecutive IDs are detected a block at a time, which is considerably
+faster for large arrays with long runs. If `n_threads > 1`, the values
+are split into chunks that are processed concurrently and the runs are
+joined at the chunk borders. The result is identical to the generic
+`fromValues`.)doc";
+
+static const char *__doc_bbp_sonata_Selection_intersectAll =
+R"doc(Intersection of all `selections`, computed in a single k-way merge
+
+Equivalent to folding `operator&` over `selections`; the intersection
+of no Selections is empty.)doc";
+
+static const char *__doc_bbp_sonata_Selection_isCanonical =
+R"doc(True if the ranges are sorted and non-overlapping
+
+This is computed once on construction. Set operations on canonical
+Selections run in linear time in the number of ranges.)doc";
+
+static const char *__doc_bbp_sonata_Selection_partition =
+R"doc(Split the Selection into `n_parts` canonical Selections of nearly
+equal `flatSize`
+
+The parts are consecutive, i.e. all IDs of part `i` are smaller than
+those of part `i + 1`, and their union is the Selection. Parts may be
+empty if there are fewer IDs than parts.)doc";
+
+static const char *__doc_bbp_sonata_Selection_partitionByReadCost =
+R"doc(Split the Selection into `n_parts` parts of nearly equal read cost
+
+As `partition`, but balances the number of elements that are read when
+the ranges are merged as in `bulk_read::sortAndMerge` with
+`min_gap_size` and `max_aggregated_block_size`, i.e. including the
+gaps that are read and later discarded.)doc";
+
 static const char *__doc_bbp_sonata_Selection_ranges = R"doc(Get a list of ranges constituting Selection)doc";
 
 static const char *__doc_bbp_sonata_Selection_ranges_2 = R"doc()doc";
 
+static const char *__doc_bbp_sonata_Selection_serialize =
+R"doc(Compact binary representation of the Selection
+
+Range bounds are stored as variable-length deltas; dense regions of
+short ranges are stored as bitmaps. The order of the ranges is
+preserved, i.e. `deserialize(s.serialize()) == s`.)doc";
+
+static const char *__doc_bbp_sonata_Selection_unionAll =
+R"doc(Union of all `selections`, computed in a single k-way merge
+
+Equivalent to folding `operator|` over `selections`, but runs in O(N
+log k) for N ranges in k Selections.)doc";
+
 static const char *__doc_bbp_sonata_SimulationConfig = R"doc(Read access to a SONATA simulation config file.)doc";
 
 static const char *__doc_bbp_sonata_SimulationConfig_Conditions = R"doc(Parameters defining global experimental conditions.)doc";
@@ -1364,20 +1934,55 @@ static const char *__doc_bbp_sonata_SpikeTimes_node_ids = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeTimes_timestamps = R"doc()doc";
 
+static const char *__doc_bbp_sonata_complement = R"doc(IDs in `[0, size)` not contained in `selection`)doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock =
+R"doc(One block of 2^16 consecutive IDs of a `CompressedSelection`.
+
+Depending on what is smallest, the low 16 bits of the IDs in the block
+are stored as: a sorted array of values, a list of runs `[first,
+last]`, or a bitmap with one bit per possible ID.)doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_Kind = R"doc()doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_Kind_array = R"doc()doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_Kind_bitmap = R"doc()doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_Kind_runs = R"doc()doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_bitmap = R"doc(For `bitmap`: 1024 words, bit `i` is set if ID `i` is in the block.)doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_cardinality = R"doc(Number of IDs in this block.)doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_key = R"doc(The upper 48 bits shared by every ID in this block.)doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_kind = R"doc()doc";
+
+static const char *__doc_bbp_sonata_detail_CompressedBlock_values = R"doc(For `array`: the sorted values; for `runs`: pairs of `first, last`.)doc";
+
 static const char *__doc_bbp_sonata_detail_NodeSets = R"doc()doc";
 
 static const char *__doc_bbp_sonata_fromValues = R"doc()doc";
 
 static const char *__doc_bbp_sonata_getAttribute = R"doc()doc";
 
-static const char *__doc_bbp_sonata_operator_band = R"doc()doc";
+static const char *__doc_bbp_sonata_operator_band = R"doc(Intersection, i.e. the IDs contained in both Selections)doc";
+
+static const char *__doc_bbp_sonata_operator_bor = R"doc(Union, i.e. the IDs contained in either Selection)doc";
 
-static const char *__doc_bbp_sonata_operator_bor = R"doc()doc";
+static const char *__doc_bbp_sonata_operator_bxor =
+R"doc(Symmetric difference, i.e. the IDs contained in exactly one of the
+Selections)doc";
 
 static const char *__doc_bbp_sonata_operator_eq = R"doc()doc";
 
 static const char *__doc_bbp_sonata_operator_ne = R"doc()doc";
 
+static const char *__doc_bbp_sonata_operator_sub =
+R"doc(Difference, i.e. the IDs of the first Selection not contained in the
+second)doc";
+
 static const char *__doc_bbp_sonata_version = R"doc()doc";
 
 #if defined(__GNUG__)
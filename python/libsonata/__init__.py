@@ -23,7 +23,12 @@ from libsonata._libsonata import (
     SpikePopulation,
     SpikeReader,
     version,
+    Hdf5BlockCache,
+    Hdf5ColumnCache,
+    Hdf5DatasetStatistics,
     Hdf5Reader,
+    Hdf5ReaderOptions,
+    Hdf5ReaderStatistics,
 )
 
 
@@ -47,7 +52,12 @@ __all__ = [
     "SpikePopulation",
     "SpikeReader",
     "version",
+    "Hdf5BlockCache",
+    "Hdf5ColumnCache",
+    "Hdf5DatasetStatistics",
     "Hdf5Reader",
+    "Hdf5ReaderOptions",
+    "Hdf5ReaderStatistics",
 ]
 
 def make_collective_reader(comm, collective_metadata, collective_transfer):
@@ -61,6 +71,10 @@ def make_collective_reader(comm, collective_metadata, collective_transfer):
 
     If `libsonata_mpi` hasn't been installed, the function returns the default
     Hdf5Reader.
+
+    Note that `libsonata_mpi` is a separate package, rather than a binding of
+    the C++ `sonata_mpi` library: this module is built without MPI and against
+    a serial HDF5, while collective I/O needs an MPI-enabled HDF5.
     """
     try:
         import libsonata_mpi
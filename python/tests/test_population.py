@@ -1,5 +1,6 @@
 import os
 import pathlib
+import pickle
 import unittest
 
 import numpy as np
@@ -14,6 +15,11 @@ from libsonata import (CircuitConfig,
                        SonataError,
                        SpikeReader,
                        EdgeStorage,
+                       Hdf5BlockCache,
+                       Hdf5ColumnCache,
+                       Hdf5Reader,
+                       Hdf5ReaderOptions,
+                       Hdf5ReaderStatistics,
                        )
 
 
@@ -88,6 +94,37 @@ class TestSelection(unittest.TestCase):
         values_selection1 = Selection([1, 3, 4, 1])
         self.assertEqual(values_selection, values_selection1)
 
+    def test_from_mask(self):
+        self.assertEqual(Selection([]), Selection.from_mask([]))
+        self.assertEqual(Selection([]), Selection.from_mask(np.zeros(20, dtype=bool)))
+        self.assertEqual(Selection([(0, 20)]), Selection.from_mask(np.ones(20, dtype=bool)))
+
+        mask = np.zeros(100, dtype=bool)
+        mask[[1, 2, 3, 50, 98, 99]] = True
+        self.assertEqual(Selection([(1, 4), (50, 51), (98, 100)]), Selection.from_mask(mask))
+        self.assertEqual(Selection(np.nonzero(mask)[0]), Selection.from_mask(mask))
+
+    def test_serialize(self):
+        for selection in (Selection([]),
+                          Selection([(24, 25), (13, 23), (5, 10), (0, 2), (1, 5)]),
+                          Selection(np.arange(0, 100000, 3, dtype=np.uint64))):
+            self.assertEqual(selection, Selection.deserialize(selection.serialize()))
+            restored = pickle.loads(pickle.dumps(selection))
+            self.assertEqual(selection, restored)
+            self.assertEqual(selection.ranges, restored.ranges)
+
+        self.assertRaises(SonataError, Selection.deserialize, b'')
+
+    def test_partition(self):
+        selection = Selection([(1000, 1010), (0, 1), (50, 51), (99, 100)])
+        self.assertEqual([Selection([(0, 1), (50, 51), (99, 100), (1000, 1003)]),
+                          Selection([(1003, 1010)])],
+                         selection.partition(2))
+        self.assertEqual([Selection([(0, 1), (50, 51)]),
+                          Selection([(99, 100), (1000, 1010)])],
+                         selection.partition_by_read_cost(2, min_gap_size=100))
+        self.assertRaises(SonataError, selection.partition, 0)
+
     def test_union_intersection(self):
         empty = Selection([])
         self.assertEqual(empty, empty & empty)
@@ -100,6 +137,22 @@ class TestSelection(unittest.TestCase):
         self.assertEqual(empty, odd & even)
         self.assertEqual(Selection(list(range(10))), odd | even)
 
+    def test_difference_complement(self):
+        empty = Selection([])
+        self.assertEqual(empty, empty - empty)
+        self.assertEqual(empty, empty ^ empty)
+
+        even = Selection(list(range(0, 10, 2)))
+        odd = Selection(list(range(1, 10, 2)))
+        self.assertEqual(even, even - odd)
+        self.assertEqual(empty, even - even)
+        self.assertEqual(Selection(list(range(10))), odd ^ even)
+        self.assertEqual(Selection([(1, 9)]), Selection([(0, 10)]) ^ Selection([(0, 1), (9, 10)]))
+
+        self.assertEqual(odd, even.complement(10))
+        self.assertEqual(Selection([(0, 10)]), empty.complement(10))
+        self.assertEqual(empty, Selection([(0, 10)]).complement(10))
+
 
 class TestNodePopulation(unittest.TestCase):
     def setUp(self):
@@ -109,6 +162,175 @@ class TestNodePopulation(unittest.TestCase):
     def test_name(self):
         self.assertEqual(self.test_obj.name, "nodes-A")
 
+    def test_get_attributes(self):
+        selection = Selection([(5, 6), (0, 2)])
+        names = ['attr-Z', 'attr-X', 'E-mapping-good', 'attr-Y']
+        result = self.test_obj.get_attributes(names, selection)
+        self.assertEqual(list(result), names)
+        for name in names:
+            expected = self.test_obj.get_attribute(name, selection)
+            self.assertEqual(result[name].dtype, expected.dtype)
+            self.assertEqual(result[name].tolist(), expected.tolist())
+
+        self.assertRaises(SonataError, self.test_obj.get_attributes, ['no-such-attribute'],
+                          selection)
+
+    def test_get_attribute_into(self):
+        selection = Selection([(5, 6), (0, 2)])
+        out = np.zeros(3, dtype=np.float64)
+        result = self.test_obj.get_attribute_into('attr-X', selection, out)
+        self.assertIs(result, out)
+        self.assertEqual(out.tolist(), self.test_obj.get_attribute('attr-X', selection).tolist())
+
+        self.assertRaises(SonataError, self.test_obj.get_attribute_into,
+                          'attr-X', selection, np.zeros(3, dtype=np.float32))
+        self.assertRaises(SonataError, self.test_obj.get_attribute_into,
+                          'attr-X', selection, np.zeros(4, dtype=np.float64))
+        self.assertRaises(SonataError, self.test_obj.get_attribute_into,
+                          'attr-Z', selection, np.zeros(3, dtype=np.float64))
+
+    def test_hdf5_reader_options(self):
+        options = Hdf5ReaderOptions()
+        options.min_gap_bytes = 8
+        options.max_aggregated_block_bytes = 16
+        options.chunk_aware = False
+        reader = Hdf5Reader(options)
+        self.assertEqual(reader.options.min_gap_bytes, 8)
+        self.assertFalse(reader.options.chunk_aware)
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=reader).open_population('nodes-A')
+        selection = Selection([(0, 1), (2, 4), (5, 6)])
+        self.assertEqual(population.get_attribute('attr-X', selection).tolist(),
+                         self.test_obj.get_attribute('attr-X', selection).tolist())
+
+        for read_mode in (Hdf5ReaderOptions.ReadMode.automatic,
+                          Hdf5ReaderOptions.ReadMode.merge,
+                          Hdf5ReaderOptions.ReadMode.hyperslab):
+            options = Hdf5ReaderOptions()
+            options.read_mode = read_mode
+            population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+            self.assertEqual(population.get_attribute('attr-Z', selection).tolist(),
+                             self.test_obj.get_attribute('attr-Z', selection).tolist())
+
+        for n_reader_threads in (1, 2, 4):
+            options = Hdf5ReaderOptions()
+            options.read_mode = Hdf5ReaderOptions.ReadMode.merge
+            options.min_gap_bytes = 0
+            options.n_reader_threads = n_reader_threads
+            options.prefetch_depth = n_reader_threads - 1
+            options.n_decompression_threads = n_reader_threads
+            population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+            self.assertEqual(population.get_attribute('attr-X', selection).tolist(),
+                             self.test_obj.get_attribute('attr-X', selection).tolist())
+
+    def test_hdf5_reader_statistics(self):
+        options = Hdf5ReaderOptions()
+        options.read_mode = Hdf5ReaderOptions.ReadMode.merge
+        options.min_gap_bytes = 0
+        options.chunk_aware = False
+        options.statistics = Hdf5ReaderStatistics()
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+        population.get_attribute('attr-X', Selection([(0, 1), (2, 4), (5, 6)]))
+        population.get_attribute('attr-X', Selection([(5, 6), (0, 1)]))
+
+        statistics = options.statistics.snapshot()['/nodes/nodes-A/0/attr-X']
+        self.assertEqual(statistics.n_read_calls, 5)
+        self.assertEqual(statistics.n_elements_requested, 6)
+        self.assertEqual(statistics.n_elements_read, 6)
+        self.assertEqual(statistics.n_canonicalizations, 1)
+        self.assertEqual(sum(statistics.latency_histogram), 5)
+
+        options.statistics.reset()
+        self.assertEqual(options.statistics.snapshot(), {})
+
+    def test_hdf5_block_cache(self):
+        options = Hdf5ReaderOptions()
+        options.block_cache = Hdf5BlockCache(1 << 20, block_bytes=16)
+        self.assertEqual(options.block_cache.block_bytes, 16)
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+        selection = Selection([(0, 1), (2, 4), (5, 6)])
+        for _ in range(2):
+            self.assertEqual(population.get_attribute('attr-X', selection).tolist(),
+                             self.test_obj.get_attribute('attr-X', selection).tolist())
+        self.assertEqual(options.block_cache.misses, 3)
+        self.assertEqual(options.block_cache.hits, 3)
+
+        options.block_cache.clear()
+        self.assertEqual(options.block_cache.bytes, 0)
+
+    def test_hdf5_column_cache(self):
+        options = Hdf5ReaderOptions()
+        options.column_cache = Hdf5ColumnCache(1 << 20)
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+        population.preload(['attr-X', 'E-mapping-good'])
+        misses = options.column_cache.misses
+
+        selection = Selection([(0, 1), (2, 4), (5, 6)])
+        for name in ['attr-X', 'E-mapping-good']:
+            self.assertEqual(population.get_attribute(name, selection).tolist(),
+                             self.test_obj.get_attribute(name, selection).tolist())
+        self.assertEqual(options.column_cache.misses, misses)
+        self.assertEqual(options.column_cache.hits, 3)
+
+        population.evict()
+        self.assertEqual(options.column_cache.bytes, 0)
+        self.assertRaises(SonataError, self.test_obj.preload, ['attr-X'])
+
+    def test_hdf5_memory_map(self):
+        options = Hdf5ReaderOptions()
+        options.memory_map = True
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+        for selection in (Selection([(1, 4)]), Selection([(0, 1), (2, 4), (5, 6)])):
+            expected = self.test_obj.get_attribute('attr-X', selection).tolist()
+            self.assertEqual(population.get_attribute('attr-X', selection).tolist(), expected)
+
+            view = population.get_attribute_view('attr-X', selection)
+            self.assertEqual(view.tolist(), expected)
+            self.assertFalse(view.flags.writeable)
+
+        self.assertEqual(population.get_attribute_view('attr-Z', Selection([(0, 2)])).tolist(),
+                         ['aa', 'bb'])
+
+    def test_hdf5_io_uring(self):
+        options = Hdf5ReaderOptions()
+        options.io_uring_queue_depth = 4
+        self.assertEqual(options.io_uring_queue_depth, 4)
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        population = NodeStorage(path, hdf5_reader=Hdf5Reader(options)).open_population('nodes-A')
+        for selection in (Selection([(1, 4)]), Selection([(0, 1), (2, 4), (5, 6)])):
+            for name in ('attr-X', 'attr-Z'):
+                self.assertEqual(population.get_attribute(name, selection).tolist(),
+                                 self.test_obj.get_attribute(name, selection).tolist())
+
+    def test_hdf5_locking(self):
+        self.assertEqual(Hdf5ReaderOptions().locking, Hdf5ReaderOptions.Locking.automatic)
+
+        path = os.path.join(PATH, 'nodes1.h5')
+        selection = Selection([(0, 1), (2, 4), (5, 6)])
+        for locking in (Hdf5ReaderOptions.Locking.automatic,
+                        Hdf5ReaderOptions.Locking.global_,
+                        Hdf5ReaderOptions.Locking.per_file,
+                        Hdf5ReaderOptions.Locking.none):
+            options = Hdf5ReaderOptions()
+            options.locking = locking
+            self.assertEqual(options.locking, locking)
+
+            storage = NodeStorage(path, hdf5_reader=Hdf5Reader(options))
+            population = storage.open_population('nodes-A')
+            for name in ('attr-X', 'attr-Z', 'E-mapping-good'):
+                self.assertEqual(population.get_attribute(name, selection).tolist(),
+                                 self.test_obj.get_attribute(name, selection).tolist())
+
     def test_size(self):
         self.assertEqual(self.test_obj.size, 6)
         self.assertEqual(len(self.test_obj), 6)
@@ -154,6 +154,10 @@ class TestElementReportReader(unittest.TestCase):
         self.assertEqual(len(self.test_obj['All'].get(tstride=2).data), 10)  # Number of times in this range
         self.assertEqual(len(self.test_obj['All'].get(tstride=2).times), 10)  # Should be the same
         self.assertEqual(len(self.test_obj['All'].get().ids), 100)
+        for prefetch_depth in (1, 3):
+            np.testing.assert_array_equal(
+                self.test_obj['All'].get(tstride=2, prefetch_depth=prefetch_depth).data,
+                self.test_obj['All'].get(tstride=2).data)
         sel = self.test_obj['All'].get(node_ids=[13, 14], tstart=0.8, tstop=1.2)
         keys = sel.ids
         keys_ref = np.asarray([(13, 30), (13, 30), (13, 31), (13, 31), (13, 32), (14, 32), (14, 33), (14, 33), (14, 34), (14, 34)])
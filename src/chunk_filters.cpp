@@ -0,0 +1,90 @@
+#include "chunk_filters.hpp"
+
+#include <bbp/sonata/common.h>
+
+#include <algorithm>
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+namespace {
+
+void inflate(const std::vector<char>& chunk, size_t chunk_bytes, std::vector<char>& out) {
+    out.resize(chunk_bytes);
+    auto n_bytes = static_cast<uLongf>(chunk_bytes);
+    const int status = uncompress(reinterpret_cast<Bytef*>(out.data()),
+                                  &n_bytes,
+                                  reinterpret_cast<const Bytef*>(chunk.data()),
+                                  static_cast<uLong>(chunk.size()));
+    if (status != Z_OK || n_bytes != chunk_bytes) {
+        throw SonataError(fmt::format("Failed to decompress a chunk: {}", zError(status)));
+    }
+}
+
+// The shuffle filter stores byte `j` of element `i` at `j * n_elements + i`;
+// trailing bytes which don't form a whole element are left in place.
+void unshuffle(const std::vector<char>& chunk, size_t element_size, std::vector<char>& out) {
+    out.resize(chunk.size());
+    const size_t n_elements = chunk.size() / element_size;
+    for (size_t j = 0; j < element_size; ++j) {
+        const char* in = chunk.data() + j * n_elements;
+        for (size_t i = 0; i < n_elements; ++i) {
+            out[i * element_size + j] = in[i];
+        }
+    }
+    std::copy(chunk.begin() + static_cast<ptrdiff_t>(n_elements * element_size),
+              chunk.end(),
+              out.begin() + static_cast<ptrdiff_t>(n_elements * element_size));
+}
+
+}  // unnamed namespace
+
+std::vector<H5Z_filter_t> revertibleFilters(hid_t dcpl) {
+    const int n_filters = H5Pget_nfilters(dcpl);
+    std::vector<H5Z_filter_t> filters;
+    for (int i = 0; i < n_filters; ++i) {
+        unsigned int flags = 0;
+        size_t n_values = 0;
+        const auto filter = H5Pget_filter2(
+            dcpl, static_cast<unsigned>(i), &flags, &n_values, nullptr, 0, nullptr, nullptr);
+        if (filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE) {
+            return {};
+        }
+        filters.push_back(filter);
+    }
+    return filters;
+}
+
+void unfilterChunk(const std::vector<H5Z_filter_t>& filters,
+                   uint32_t filter_mask,
+                   size_t element_size,
+                   size_t chunk_bytes,
+                   std::vector<char>& chunk,
+                   std::vector<char>& buffer) {
+    for (size_t i = filters.size(); i-- > 0;) {
+        if ((filter_mask & (uint32_t(1) << i)) != 0) {
+            continue;
+        }
+
+        if (filters[i] == H5Z_FILTER_DEFLATE) {
+            inflate(chunk, chunk_bytes, buffer);
+        } else {
+            unshuffle(chunk, element_size, buffer);
+        }
+        chunk.swap(buffer);
+    }
+
+    if (chunk.size() != chunk_bytes) {
+        throw SonataError(
+            fmt::format("Expected a chunk of {} bytes, got {}", chunk_bytes, chunk.size()));
+    }
+}
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <hdf5.h>
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+/// The filter pipeline of the dataset creation properties `dcpl`, if it's
+/// not empty and `unfilterChunk` can revert every filter; otherwise empty.
+///
+/// Supported are deflate (gzip) and shuffle.
+std::vector<H5Z_filter_t> revertibleFilters(hid_t dcpl);
+
+/// Revert the `filters` applied to the raw `chunk`, as read by `H5Dread_chunk`.
+///
+/// Filter `i` is skipped if bit `i` of `filter_mask` is set. On return,
+/// `chunk` holds the `chunk_bytes` bytes of the chunk, made of elements of
+/// `element_size` bytes; `buffer` is used as scratch space.
+void unfilterChunk(const std::vector<H5Z_filter_t>& filters,
+                   uint32_t filter_mask,
+                   size_t element_size,
+                   size_t chunk_bytes,
+                   std::vector<char>& chunk,
+                   std::vector<char>& buffer);
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,496 @@
+#include <bbp/sonata/compressed_selection.h>
+
+#include <algorithm>  // std::lower_bound, std::min
+#include <array>
+
+#include "read_bulk.hpp"
+
+namespace bbp {
+namespace sonata {
+
+namespace detail {
+
+bool operator==(const CompressedBlock& lhs, const CompressedBlock& rhs) {
+    return lhs.key == rhs.key && lhs.kind == rhs.kind && lhs.cardinality == rhs.cardinality &&
+           lhs.values == rhs.values && lhs.bitmap == rhs.bitmap;
+}
+
+}  // namespace detail
+
+namespace {
+
+using detail::CompressedBlock;
+using Kind = CompressedBlock::Kind;
+
+constexpr size_t BLOCK_BITS = 16;
+constexpr uint32_t BLOCK_SIZE = uint32_t(1) << BLOCK_BITS;
+constexpr size_t BITMAP_WORDS = BLOCK_SIZE / 64;
+constexpr size_t BITMAP_BYTES = BITMAP_WORDS * sizeof(uint64_t);
+
+// Half-open runs `[begin, end)` of the low 16 bits of IDs; `end` may be 2^16.
+using Run = std::array<uint32_t, 2>;
+using Runs = std::vector<Run>;
+using Bitmap = std::vector<uint64_t>;
+
+inline uint32_t popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<uint32_t>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline uint32_t countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+    uint32_t n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+void setRun(Bitmap& words, uint32_t begin, uint32_t end) {
+    if (begin >= end) {
+        return;
+    }
+
+    const uint32_t first_word = begin / 64;
+    const uint32_t last_word = (end - 1) / 64;
+    const uint64_t first_mask = ~uint64_t(0) << (begin % 64);
+    const uint64_t last_mask = ~uint64_t(0) >> (63 - (end - 1) % 64);
+
+    if (first_word == last_word) {
+        words[first_word] |= first_mask & last_mask;
+        return;
+    }
+
+    words[first_word] |= first_mask;
+    for (uint32_t i = first_word + 1; i < last_word; ++i) {
+        words[i] = ~uint64_t(0);
+    }
+    words[last_word] |= last_mask;
+}
+
+Runs bitmapToRuns(const Bitmap& words) {
+    Runs runs;
+    for (uint32_t i = 0; i < BITMAP_WORDS; ++i) {
+        uint64_t word = words[i];
+        while (word != 0) {
+            const uint32_t begin = i * 64 + countTrailingZeros(word);
+            // Fill the bits below the run, then find the first zero above it.
+            word |= word - 1;
+            uint32_t end = 0;
+            if (word == ~uint64_t(0)) {
+                // The run continues into the next word(s).
+                uint32_t j = i + 1;
+                while (j < BITMAP_WORDS && words[j] == ~uint64_t(0)) {
+                    ++j;
+                }
+                if (j == BITMAP_WORDS) {
+                    runs.push_back({begin, BLOCK_SIZE});
+                    return runs;
+                }
+                i = j;
+                word = words[j];
+                end = j * 64 + countTrailingZeros(~word);
+            } else {
+                end = i * 64 + countTrailingZeros(~word);
+            }
+            runs.push_back({begin, end});
+            // Clear everything below `end`.
+            word &= ~uint64_t(0) << (end % 64);
+        }
+    }
+    return runs;
+}
+
+Runs toRuns(const CompressedBlock& block) {
+    Runs runs;
+    switch (block.kind) {
+    case Kind::runs:
+        runs.reserve(block.values.size() / 2);
+        for (size_t i = 0; i < block.values.size(); i += 2) {
+            runs.push_back({uint32_t(block.values[i]), uint32_t(block.values[i + 1]) + 1});
+        }
+        return runs;
+    case Kind::array:
+        for (const auto v : block.values) {
+            if (!runs.empty() && runs.back()[1] == v) {
+                ++runs.back()[1];
+            } else {
+                runs.push_back({uint32_t(v), uint32_t(v) + 1});
+            }
+        }
+        return runs;
+    case Kind::bitmap:
+        return bitmapToRuns(block.bitmap);
+    default:                        // LCOV_EXCL_LINE
+        LIBSONATA_THROW_IF_REACHED  // LCOV_EXCL_LINE
+    }
+}
+
+/// Returns a reference to the bitmap of `block`, materializing it in `storage` if needed.
+const Bitmap& bitmapOf(const CompressedBlock& block, Bitmap& storage) {
+    if (block.kind == Kind::bitmap) {
+        return block.bitmap;
+    }
+
+    storage.assign(BITMAP_WORDS, 0);
+    for (const auto& run : toRuns(block)) {
+        setRun(storage, run[0], run[1]);
+    }
+    return storage;
+}
+
+/// Pick the smallest representation, given the runs of the block.
+CompressedBlock makeBlock(uint64_t key, const Runs& runs) {
+    CompressedBlock block;
+    block.key = key;
+    for (const auto& run : runs) {
+        block.cardinality += run[1] - run[0];
+    }
+
+    const size_t runs_bytes = runs.size() * 2 * sizeof(uint16_t);
+    const size_t array_bytes = block.cardinality * sizeof(uint16_t);
+
+    if (runs_bytes <= std::min(array_bytes, BITMAP_BYTES)) {
+        block.kind = Kind::runs;
+        block.values.reserve(2 * runs.size());
+        for (const auto& run : runs) {
+            block.values.push_back(static_cast<uint16_t>(run[0]));
+            block.values.push_back(static_cast<uint16_t>(run[1] - 1));
+        }
+    } else if (array_bytes <= BITMAP_BYTES) {
+        block.kind = Kind::array;
+        block.values.reserve(block.cardinality);
+        for (const auto& run : runs) {
+            for (uint32_t v = run[0]; v < run[1]; ++v) {
+                block.values.push_back(static_cast<uint16_t>(v));
+            }
+        }
+    } else {
+        block.kind = Kind::bitmap;
+        block.bitmap.assign(BITMAP_WORDS, 0);
+        for (const auto& run : runs) {
+            setRun(block.bitmap, run[0], run[1]);
+        }
+    }
+
+    return block;
+}
+
+/// Pick the smallest representation, given the bitmap of the block.
+CompressedBlock makeBlock(uint64_t key, Bitmap&& words) {
+    uint32_t cardinality = 0;
+    size_t n_runs = 0;
+    uint64_t carry = 0;
+    for (const auto word : words) {
+        cardinality += popcount(word);
+        // A run starts wherever a set bit follows an unset one.
+        n_runs += popcount(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+
+    const size_t runs_bytes = n_runs * 2 * sizeof(uint16_t);
+    const size_t array_bytes = cardinality * sizeof(uint16_t);
+    if (cardinality == 0 || runs_bytes <= std::min(array_bytes, BITMAP_BYTES) ||
+        array_bytes <= BITMAP_BYTES) {
+        return makeBlock(key, bitmapToRuns(words));
+    }
+
+    CompressedBlock block;
+    block.key = key;
+    block.kind = Kind::bitmap;
+    block.cardinality = cardinality;
+    block.bitmap = std::move(words);
+    return block;
+}
+
+Runs intersectRuns(const Runs& lhs, const Runs& rhs) {
+    Runs ret;
+    auto it0 = lhs.cbegin();
+    auto it1 = rhs.cbegin();
+    while (it0 != lhs.cend() && it1 != rhs.cend()) {
+        const auto begin = std::max((*it0)[0], (*it1)[0]);
+        const auto end = std::min((*it0)[1], (*it1)[1]);
+        if (begin < end) {
+            ret.push_back({begin, end});
+        }
+
+        if ((*it0)[1] < (*it1)[1]) {
+            ++it0;
+        } else {
+            ++it1;
+        }
+    }
+    return ret;
+}
+
+Runs uniteRuns(const Runs& lhs, const Runs& rhs) {
+    Runs ret;
+    ret.reserve(lhs.size() + rhs.size());
+
+    const auto append = [&ret](const Run& run) {
+        if (!ret.empty() && ret.back()[1] >= run[0]) {
+            ret.back()[1] = std::max(ret.back()[1], run[1]);
+        } else {
+            ret.push_back(run);
+        }
+    };
+
+    auto it0 = lhs.cbegin();
+    auto it1 = rhs.cbegin();
+    while (it0 != lhs.cend() && it1 != rhs.cend()) {
+        if ((*it0)[0] <= (*it1)[0]) {
+            append(*(it0++));
+        } else {
+            append(*(it1++));
+        }
+    }
+    std::for_each(it0, lhs.cend(), append);
+    std::for_each(it1, rhs.cend(), append);
+
+    return ret;
+}
+
+CompressedBlock intersectBlocks(const CompressedBlock& lhs, const CompressedBlock& rhs) {
+    if (lhs.kind == Kind::bitmap || rhs.kind == Kind::bitmap) {
+        Bitmap storage;
+        Bitmap words = bitmapOf(lhs, storage);
+        const Bitmap& other = bitmapOf(rhs, storage);
+        for (size_t i = 0; i < BITMAP_WORDS; ++i) {
+            words[i] &= other[i];
+        }
+        return makeBlock(lhs.key, std::move(words));
+    }
+
+    return makeBlock(lhs.key, intersectRuns(toRuns(lhs), toRuns(rhs)));
+}
+
+CompressedBlock uniteBlocks(const CompressedBlock& lhs, const CompressedBlock& rhs) {
+    if (lhs.kind == Kind::bitmap || rhs.kind == Kind::bitmap) {
+        Bitmap storage;
+        Bitmap words = bitmapOf(lhs, storage);
+        const Bitmap& other = bitmapOf(rhs, storage);
+        for (size_t i = 0; i < BITMAP_WORDS; ++i) {
+            words[i] |= other[i];
+        }
+        return makeBlock(lhs.key, std::move(words));
+    }
+
+    return makeBlock(lhs.key, uniteRuns(toRuns(lhs), toRuns(rhs)));
+}
+
+template <class F>
+void forEachRange(const std::vector<CompressedBlock>& blocks, F f) {
+    for (const auto& block : blocks) {
+        const uint64_t base = block.key << BLOCK_BITS;
+        for (const auto& run : toRuns(block)) {
+            f(base + run[0], base + run[1]);
+        }
+    }
+}
+
+}  // unnamed namespace
+
+
+CompressedSelection::CompressedSelection(std::vector<detail::CompressedBlock> blocks)
+    : blocks_(std::move(blocks)) {}
+
+
+CompressedSelection::CompressedSelection(const Selection& selection)
+    : CompressedSelection(selection.ranges()) {}
+
+
+CompressedSelection::CompressedSelection(const Ranges& ranges) {
+    Runs runs;
+    uint64_t current_key = 0;
+
+    for (const auto& range : bulk_read::sortAndMerge(ranges)) {
+        Value begin = std::get<0>(range);
+        const Value end = std::get<1>(range);
+
+        while (begin < end) {
+            const uint64_t key = begin >> BLOCK_BITS;
+            if (key != current_key && !runs.empty()) {
+                blocks_.push_back(makeBlock(current_key, runs));
+                runs.clear();
+            }
+            current_key = key;
+
+            // `block_end` wraps to 0 for the very last block.
+            const Value block_end = (key + 1) << BLOCK_BITS;
+            const Value stop = (block_end == 0 || end < block_end) ? end : block_end;
+            runs.push_back({uint32_t(begin - (key << BLOCK_BITS)),
+                            uint32_t(stop - (key << BLOCK_BITS))});
+            begin = stop;
+        }
+    }
+
+    if (!runs.empty()) {
+        blocks_.push_back(makeBlock(current_key, runs));
+    }
+}
+
+
+CompressedSelection CompressedSelection::fromValues(const Values& values) {
+    return CompressedSelection(Selection::fromValues(values));
+}
+
+
+CompressedSelection::Ranges CompressedSelection::ranges() const {
+    Ranges ret;
+    forEachRange(blocks_, [&ret](Value begin, Value end) {
+        if (!ret.empty() && std::get<1>(ret.back()) == begin) {
+            std::get<1>(ret.back()) = end;
+        } else {
+            ret.push_back({begin, end});
+        }
+    });
+    return ret;
+}
+
+
+CompressedSelection::Values CompressedSelection::flatten() const {
+    Values ret;
+    ret.reserve(flatSize());
+    forEachRange(blocks_, [&ret](Value begin, Value end) {
+        for (auto v = begin; v < end; ++v) {
+            ret.push_back(v);
+        }
+    });
+    return ret;
+}
+
+
+size_t CompressedSelection::flatSize() const {
+    size_t size = 0;
+    for (const auto& block : blocks_) {
+        size += block.cardinality;
+    }
+    return size;
+}
+
+
+bool CompressedSelection::empty() const {
+    return blocks_.empty();
+}
+
+
+bool CompressedSelection::contains(Value value) const {
+    const uint64_t key = value >> BLOCK_BITS;
+    const auto low = static_cast<uint16_t>(value & (BLOCK_SIZE - 1));
+
+    const auto it = std::lower_bound(blocks_.cbegin(),
+                                     blocks_.cend(),
+                                     key,
+                                     [](const CompressedBlock& block, uint64_t k) {
+                                         return block.key < k;
+                                     });
+    if (it == blocks_.cend() || it->key != key) {
+        return false;
+    }
+
+    switch (it->kind) {
+    case Kind::array:
+        return std::binary_search(it->values.cbegin(), it->values.cend(), low);
+    case Kind::runs:
+        for (size_t i = 0; i < it->values.size(); i += 2) {
+            if (low < it->values[i]) {
+                return false;
+            }
+            if (low <= it->values[i + 1]) {
+                return true;
+            }
+        }
+        return false;
+    case Kind::bitmap:
+        return ((it->bitmap[low / 64] >> (low % 64)) & 1) != 0;
+    default:                        // LCOV_EXCL_LINE
+        LIBSONATA_THROW_IF_REACHED  // LCOV_EXCL_LINE
+    }
+}
+
+
+Selection CompressedSelection::toSelection() const {
+    return Selection(ranges());
+}
+
+
+size_t CompressedSelection::memoryUsage() const {
+    size_t bytes = blocks_.size() * sizeof(CompressedBlock);
+    for (const auto& block : blocks_) {
+        bytes += block.values.size() * sizeof(uint16_t) + block.bitmap.size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+
+const std::vector<detail::CompressedBlock>& CompressedSelection::blocks() const {
+    return blocks_;
+}
+
+
+bool operator==(const CompressedSelection& lhs, const CompressedSelection& rhs) {
+    // The representation of a block only depends on its contents.
+    return lhs.blocks() == rhs.blocks();
+}
+
+
+bool operator!=(const CompressedSelection& lhs, const CompressedSelection& rhs) {
+    return !(lhs == rhs);
+}
+
+
+CompressedSelection operator&(const CompressedSelection& lhs, const CompressedSelection& rhs) {
+    std::vector<CompressedBlock> ret;
+
+    auto it0 = lhs.blocks_.cbegin();
+    auto it1 = rhs.blocks_.cbegin();
+    while (it0 != lhs.blocks_.cend() && it1 != rhs.blocks_.cend()) {
+        if (it0->key < it1->key) {
+            ++it0;
+        } else if (it1->key < it0->key) {
+            ++it1;
+        } else {
+            auto block = intersectBlocks(*(it0++), *(it1++));
+            if (block.cardinality != 0) {
+                ret.push_back(std::move(block));
+            }
+        }
+    }
+
+    return CompressedSelection(std::move(ret));
+}
+
+
+CompressedSelection operator|(const CompressedSelection& lhs, const CompressedSelection& rhs) {
+    std::vector<CompressedBlock> ret;
+    ret.reserve(std::max(lhs.blocks_.size(), rhs.blocks_.size()));
+
+    auto it0 = lhs.blocks_.cbegin();
+    auto it1 = rhs.blocks_.cbegin();
+    while (it0 != lhs.blocks_.cend() && it1 != rhs.blocks_.cend()) {
+        if (it0->key < it1->key) {
+            ret.push_back(*(it0++));
+        } else if (it1->key < it0->key) {
+            ret.push_back(*(it1++));
+        } else {
+            ret.push_back(uniteBlocks(*(it0++), *(it1++)));
+        }
+    }
+    std::copy(it0, lhs.blocks_.cend(), std::back_inserter(ret));
+    std::copy(it1, rhs.blocks_.cend(), std::back_inserter(ret));
+
+    return CompressedSelection(std::move(ret));
+}
+
+}  // namespace sonata
+}  // namespace bbp
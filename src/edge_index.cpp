@@ -56,9 +56,15 @@ const HighFive::Group targetIndex(const HighFive::Group& h5Root) {
 
 Selection resolve(const HighFive::Group& indexGroup,
                   const std::vector<NodeID>& nodeIDs,
-                  const Hdf5Reader& reader) {
-    auto node2ranges_dset = indexGroup.getDataSet(NODE_ID_TO_RANGES_DSET);
-    auto node_dim = node2ranges_dset.getSpace().getDimensions()[0];
+                  const Hdf5Reader& reader,
+                  const detail::Hdf5Lock& lock) {
+    const detail::LockedObject<HighFive::DataSet> node2ranges_dset(lock, [&indexGroup] {
+        return indexGroup.getDataSet(NODE_ID_TO_RANGES_DSET);
+    });
+    const auto node_dim = [&] {
+        HDF5_LOCK_GUARD(lock)
+        return node2ranges_dset->getSpace().getDimensions()[0];
+    }();
     auto sortedNodeIds = nodeIDs;
     bulk_read::detail::erase_if(sortedNodeIds, [node_dim](auto id) {
         // Filter out `nodeIDs[i] >= dims`; because SYN2 used to return an
@@ -68,9 +74,12 @@ Selection resolve(const HighFive::Group& indexGroup,
     std::sort(sortedNodeIds.begin(), sortedNodeIds.end());
 
     auto nodeSelection = Selection::fromValues(sortedNodeIds);
-    auto primaryRange = reader.readSelection<std::array<uint64_t, 2>>(node2ranges_dset,
-                                                                      nodeSelection,
-                                                                      Selection(RawIndex{{0, 2}}));
+    auto primaryRange = [&] {
+        const auto plugin_lock = detail::guardPlugin(reader, lock);
+        return reader.readSelection<std::array<uint64_t, 2>>(*node2ranges_dset,
+                                                             nodeSelection,
+                                                             Selection(RawIndex{{0, 2}}));
+    }();
 
     bulk_read::detail::erase_if(primaryRange, [](const auto& range) {
         // Filter out any invalid ranges `start >= end`.
@@ -79,8 +88,15 @@ Selection resolve(const HighFive::Group& indexGroup,
 
     primaryRange = bulk_read::sortAndMerge(primaryRange);
 
-    auto secondaryRange = reader.readSelection<std::array<uint64_t, 2>>(
-        indexGroup.getDataSet(RANGE_TO_EDGE_ID_DSET), primaryRange, RawIndex{{0, 2}});
+    const detail::LockedObject<HighFive::DataSet> range2edge_dset(lock, [&indexGroup] {
+        return indexGroup.getDataSet(RANGE_TO_EDGE_ID_DSET);
+    });
+    auto secondaryRange = [&] {
+        const auto plugin_lock = detail::guardPlugin(reader, lock);
+        return reader.readSelection<std::array<uint64_t, 2>>(*range2edge_dset,
+                                                             primaryRange,
+                                                             RawIndex{{0, 2}});
+    }();
 
     // Sort and eliminate empty ranges.
     secondaryRange = bulk_read::sortAndMerge(secondaryRange);
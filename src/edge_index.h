@@ -14,6 +14,8 @@
 #include <highfive/H5File.hpp>
 #include <highfive/H5Group.hpp>
 
+#include "hdf5_mutex.hpp"
+
 namespace bbp {
 namespace sonata {
 namespace edge_index {
@@ -21,10 +23,14 @@ namespace edge_index {
 const HighFive::Group sourceIndex(const HighFive::Group& h5Root);
 const HighFive::Group targetIndex(const HighFive::Group& h5Root);
 
-Selection resolve(const HighFive::Group& indexGroup, NodeID nodeID, const Hdf5Reader& reader);
+/// The edges of `nodeIDs` in the index `indexGroup`, as a canonical selection.
+///
+/// `lock` is held around the HDF5 calls, and around the reads of `reader`
+/// unless it takes the lock itself, see `detail::guardPlugin`.
 Selection resolve(const HighFive::Group& indexGroup,
                   const std::vector<NodeID>& nodeIDs,
-                  const Hdf5Reader& reader);
+                  const Hdf5Reader& reader,
+                  const detail::Hdf5Lock& lock);
 
 void write(HighFive::Group& h5Root,
            uint64_t sourceNodeCount,
@@ -17,8 +17,6 @@
 #include <fmt/format.h>
 #include <highfive/H5File.hpp>
 
-#include <algorithm>
-
 
 namespace {
 
@@ -47,57 +45,64 @@ EdgePopulation::EdgePopulation(const std::string& h5FilePath,
 
 
 std::string EdgePopulation::source() const {
-    HDF5_LOCK_GUARD
+    HDF5_LOCK_GUARD(impl_->hdf5_lock)
     std::string result;
-    impl_->h5Root.getDataSet(SOURCE_NODE_ID_DSET).getAttribute(NODE_POPULATION_ATTR).read(result);
+    impl_->getRootInfo(SOURCE_NODE_ID_DSET)
+        .dataset.getAttribute(NODE_POPULATION_ATTR)
+        .read(result);
     return result;
 }
 
 
 std::string EdgePopulation::target() const {
-    HDF5_LOCK_GUARD
+    HDF5_LOCK_GUARD(impl_->hdf5_lock)
     std::string result;
-    impl_->h5Root.getDataSet(TARGET_NODE_ID_DSET).getAttribute(NODE_POPULATION_ATTR).read(result);
+    impl_->getRootInfo(TARGET_NODE_ID_DSET)
+        .dataset.getAttribute(NODE_POPULATION_ATTR)
+        .read(result);
     return result;
 }
 
 
 std::vector<NodeID> EdgePopulation::sourceNodeIDs(const Selection& selection) const {
-    HDF5_LOCK_GUARD
-    const auto dset = impl_->h5Root.getDataSet(SOURCE_NODE_ID_DSET);
-    return _readSelection<NodeID>(dset, selection, impl_->hdf5_reader);
+    return _readSelection<NodeID>(impl_->getRootInfo(SOURCE_NODE_ID_DSET),
+                                  selection,
+                                  impl_->hdf5_reader,
+                                  impl_->hdf5_lock);
 }
 
 
 std::vector<NodeID> EdgePopulation::targetNodeIDs(const Selection& selection) const {
-    HDF5_LOCK_GUARD
-    const auto dset = impl_->h5Root.getDataSet(TARGET_NODE_ID_DSET);
-    return _readSelection<NodeID>(dset, selection, impl_->hdf5_reader);
+    return _readSelection<NodeID>(impl_->getRootInfo(TARGET_NODE_ID_DSET),
+                                  selection,
+                                  impl_->hdf5_reader,
+                                  impl_->hdf5_lock);
 }
 
 
 Selection EdgePopulation::afferentEdges(const std::vector<NodeID>& target) const {
-    HDF5_LOCK_GUARD
-    return edge_index::resolve(edge_index::targetIndex(impl_->h5Root), target, impl_->hdf5_reader);
+    const auto& lock = impl_->hdf5_lock;
+    const detail::LockedObject<HighFive::Group> index(lock, [this] {
+        return edge_index::targetIndex(impl_->h5Root);
+    });
+    return edge_index::resolve(*index, target, impl_->hdf5_reader, lock);
 }
 
 
 Selection EdgePopulation::efferentEdges(const std::vector<NodeID>& source) const {
-    HDF5_LOCK_GUARD
-    return edge_index::resolve(edge_index::sourceIndex(impl_->h5Root), source, impl_->hdf5_reader);
+    const auto& lock = impl_->hdf5_lock;
+    const detail::LockedObject<HighFive::Group> index(lock, [this] {
+        return edge_index::sourceIndex(impl_->h5Root);
+    });
+    return edge_index::resolve(*index, source, impl_->hdf5_reader, lock);
 }
 
 
 Selection EdgePopulation::connectingEdges(const std::vector<NodeID>& source,
                                           const std::vector<NodeID>& target) const {
-    // TODO optimize: range intersection
-    const auto pre = efferentEdges(source).flatten();
-    const auto post = afferentEdges(target).flatten();
-    assert(std::is_sorted(pre.begin(), pre.end()));  // return result of _resolveIndex is sorted
-    assert(std::is_sorted(post.begin(), post.end()));
-    Selection::Values result;
-    set_intersection(pre.begin(), pre.end(), post.begin(), post.end(), std::back_inserter(result));
-    return Selection::fromValues(result);
+    // Both are canonical, see `edge_index::resolve`; hence their intersection
+    // doesn't need to flatten either of them.
+    return efferentEdges(source) & afferentEdges(target);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -106,8 +111,10 @@ void EdgePopulation::writeIndices(const std::string& h5FilePath,
                                   const std::string& population,
                                   uint64_t sourceNodeCount,
                                   uint64_t targetNodeCount,
-                                  bool overwrite) {
-    HDF5_LOCK_GUARD
+                                  bool overwrite,
+                                  const Hdf5Reader& hdf5_reader) {
+    const detail::Hdf5Lock lock(hdf5_reader.options().locking, h5FilePath);
+    HDF5_LOCK_GUARD(lock)
     HighFive::File h5File(h5FilePath, HighFive::File::ReadWrite);
     auto h5Root = h5File.getGroup(fmt::format("/edges/{}", population));
     edge_index::write(h5Root, sourceNodeCount, targetNodeCount, overwrite);
@@ -7,7 +7,19 @@
  * See top-level COPYING.LESSER and COPYING files for details.
  *************************************************************************/
 
-#include <mutex>
+#include "hdf5_mutex.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <hdf5.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
 
 
 namespace bbp {
@@ -18,5 +30,132 @@ std::mutex& hdf5Mutex() {
     return _hdf5Mutex;
 }
 
+namespace detail {
+
+bool isHdf5Threadsafe() {
+    static const bool is_threadsafe = [] {
+        hbool_t threadsafe = 0;
+        return H5is_library_threadsafe(&threadsafe) >= 0 && threadsafe;
+    }();
+    return is_threadsafe;
+}
+
+namespace {
+
+std::shared_ptr<std::mutex> globalMutex() {
+    // Aliases the global mutex, which is never destroyed.
+    return std::shared_ptr<std::mutex>(std::shared_ptr<std::mutex>(), &hdf5Mutex());
+}
+
+/// Identifies a file by its device and inode, so that all paths of the same
+/// file, e.g. relative ones or through symlinks, share one mutex. If the file
+/// can't be found, or on Windows, by its name instead.
+using FileKey = std::tuple<uint64_t, uint64_t, std::string>;
+
+FileKey fileKey(const std::string& filename) {
+#ifndef _WIN32
+    struct stat info {};
+    if (::stat(filename.c_str(), &info) == 0) {
+        return FileKey{static_cast<uint64_t>(info.st_dev),
+                       static_cast<uint64_t>(info.st_ino),
+                       std::string()};
+    }
+#endif
+    return FileKey{0, 0, filename};
+}
+
+/// The mutex of `filename`, shared for as long as any lock of the file exists.
+std::shared_ptr<std::mutex> fileMutex(const std::string& filename) {
+    static std::mutex mutex;
+    static std::map<FileKey, std::weak_ptr<std::mutex>> mutexes;
+
+    const auto key = fileKey(filename);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& file_mutex = mutexes[key];
+    if (auto existing = file_mutex.lock()) {
+        return existing;
+    }
+
+    // Forget the files which aren't open anymore.
+    for (auto it = mutexes.begin(); it != mutexes.end();) {
+        if (it->second.expired() && it->first != key) {
+            it = mutexes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto created = std::make_shared<std::mutex>();
+    file_mutex = created;
+    return created;
+}
+
+/// The mutexes of the `Hdf5Lock::Guard`s alive in this thread.
+std::vector<const std::mutex*>& heldMutexes() {
+    static thread_local std::vector<const std::mutex*> held;
+    return held;
+}
+
+}  // unnamed namespace
+
+Hdf5Lock::Guard::Guard(std::mutex* mutex)
+    : mutex_(mutex) {
+    if (mutex_ != nullptr) {
+        mutex_->lock();
+        heldMutexes().push_back(mutex_);
+    }
+}
+
+Hdf5Lock::Guard::Guard(Guard&& other) noexcept
+    : mutex_(other.mutex_) {
+    other.mutex_ = nullptr;
+}
+
+Hdf5Lock::Guard::~Guard() {
+    if (mutex_ != nullptr) {
+        auto& held = heldMutexes();
+        held.erase(std::find(held.rbegin(), held.rend(), mutex_).base() - 1);
+        mutex_->unlock();
+    }
+}
+
+Hdf5Lock::Hdf5Lock()
+    : mutex_(globalMutex()) {}
+
+Hdf5Lock::Hdf5Lock(Hdf5ReaderOptions::Locking locking, const std::string& filename) {
+    using Locking = Hdf5ReaderOptions::Locking;
+    if (!isHdf5Threadsafe() || locking == Locking::global) {
+        // HDF5 shares its state across files, hence only a global lock keeps
+        // a library which isn't thread-safe safe.
+        mutex_ = globalMutex();
+    } else if (locking == Locking::per_file) {
+        mutex_ = fileMutex(filename);
+    }
+}
+
+Hdf5Lock Hdf5Lock::forRead(Hdf5ReaderOptions::Locking locking, const HighFive::DataSet& dset) {
+    using Locking = Hdf5ReaderOptions::Locking;
+    const bool per_file = isHdf5Threadsafe() && locking == Locking::per_file;
+    const auto lock = per_file ? Hdf5Lock(locking, dset.getFile().getName())
+                               : Hdf5Lock(locking, std::string());
+    if (lock.isHeld()) {
+        return Hdf5Lock(std::make_shared<std::mutex>());
+    }
+    return lock;
+}
+
+bool Hdf5Lock::isHeld() const {
+    const auto& held = heldMutexes();
+    return mutex_ != nullptr && std::find(held.begin(), held.end(), mutex_.get()) != held.end();
+}
+
+Hdf5Lock::Guard guardPlugin(const Hdf5Reader& reader, const Hdf5Lock& lock) {
+    if (readerResources(reader) != nullptr) {
+        return Hdf5Lock::Guard();
+    }
+    return lock.guard();
+}
+
+}  // namespace detail
 }  // namespace sonata
 }  // namespace bbp
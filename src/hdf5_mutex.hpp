@@ -9,12 +9,19 @@
 
 #pragma once
 
+#include <memory>  // std::shared_ptr
 #include <mutex>
+#include <string>
+#include <utility>
+
+#include <bbp/sonata/hdf5_reader.h>
 
 // Every access to hdf5 must be serialized if HDF5 does not take care of it
 // which needs a thread-safe built of the library.
 // https://support.hdfgroup.org/HDF5/faq/threadsafe.html
-#define HDF5_LOCK_GUARD std::lock_guard<std::mutex> _hdf5_lock(hdf5Mutex());
+//
+// Holds `lock`, a `detail::Hdf5Lock`, until the end of the scope.
+#define HDF5_LOCK_GUARD(lock) const auto _hdf5_lock = (lock).guard();
 
 
 namespace bbp {
@@ -22,5 +29,101 @@ namespace sonata {
 
 std::mutex& hdf5Mutex();
 
-}
+namespace detail {
+
+/// True if HDF5 was built thread-safe, i.e. serializes its API calls itself.
+bool isHdf5Threadsafe();
+
+/// The lock taken around the HDF5 calls for one file.
+///
+/// Depending on the `Hdf5ReaderOptions::Locking` strategy, this is the global
+/// `hdf5Mutex()`, a mutex shared by all locks of the same file, whichever path
+/// it was opened with, or no lock at all. Without a thread-safe HDF5 it is
+/// always the global mutex.
+class Hdf5Lock
+{
+  public:
+    /// Holds a lock until it is destroyed, see `guard`.
+    class Guard
+    {
+      public:
+        /// Locks `mutex`, unless it's `nullptr`.
+        explicit Guard(std::mutex* mutex = nullptr);
+        Guard(Guard&& other) noexcept;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+        ~Guard();
+
+      private:
+        std::mutex* mutex_;
+    };
+
+    /// The global lock.
+    Hdf5Lock();
+
+    Hdf5Lock(Hdf5ReaderOptions::Locking locking, const std::string& filename);
+
+    /// The lock taken by the default plugin while reading `dset`.
+    ///
+    /// The name of the file is only queried for `per_file` locking, which
+    /// requires a thread-safe HDF5. If the calling thread holds the lock
+    /// already, e.g. because a plugin called with the lock held reads through
+    /// a default `Hdf5Reader`, it keeps all other threads out of HDF5; the
+    /// threads of the read then only take turns among themselves.
+    static Hdf5Lock forRead(Hdf5ReaderOptions::Locking locking, const HighFive::DataSet& dset);
+
+    /// Lock for as long as the returned object lives, see `HDF5_LOCK_GUARD`.
+    Guard guard() const {
+        return Guard(mutex_.get());
+    }
+
+    /// True if the calling thread holds this lock.
+    bool isHeld() const;
+
+  private:
+    explicit Hdf5Lock(std::shared_ptr<std::mutex> mutex)
+        : mutex_(std::move(mutex)) {}
+
+    std::shared_ptr<std::mutex> mutex_;
+};
+
+/// An HDF5 object, e.g. a `HighFive::DataSet`, which is opened and closed
+/// holding `lock`, as closing it is an HDF5 call as well.
+template <class Object>
+class LockedObject
+{
+  public:
+    /// Holds `lock` while calling `open()`, which returns the object.
+    template <class F>
+    LockedObject(const Hdf5Lock& lock, F open)
+        : lock_(lock) {
+        HDF5_LOCK_GUARD(lock_)
+        object_.reset(new Object(open()));
+    }
+
+    ~LockedObject() {
+        HDF5_LOCK_GUARD(lock_)
+        object_.reset();
+    }
+
+    const Object& operator*() const {
+        return *object_;
+    }
+
+    const Object* operator->() const {
+        return object_.get();
+    }
+
+  private:
+    Hdf5Lock lock_;
+    std::unique_ptr<Object> object_;
+};
+
+/// Holds `lock` for a call of the plugin of `reader`, unless it's the default
+/// plugin, which only takes the lock around the HDF5 calls it makes.
+Hdf5Lock::Guard guardPlugin(const Hdf5Reader& reader, const Hdf5Lock& lock);
+
+}  // namespace detail
+}  // namespace sonata
 }  // namespace bbp
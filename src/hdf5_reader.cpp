@@ -2,21 +2,300 @@
 
 #include "hdf5_reader.hpp"
 
+#include <list>
+#include <map>
+#include <set>
+#include <tuple>
+
 namespace bbp {
 namespace sonata {
 
 
 Hdf5Reader::Hdf5Reader()
+    : Hdf5Reader(Hdf5ReaderOptions()) {}
+
+Hdf5Reader::Hdf5Reader(const Hdf5ReaderOptions& options)
     : impl(std::make_shared<
-           Hdf5PluginDefault<Hdf5Reader::supported_1D_types, supported_2D_types>>()) {}
+           Hdf5PluginDefault<Hdf5Reader::supported_1D_types, supported_2D_types>>(options))
+    , options_(options) {}
 
 Hdf5Reader::Hdf5Reader(
     std::shared_ptr<Hdf5PluginInterface<supported_1D_types, supported_2D_types>> impl)
     : impl(std::move(impl)) {}
 
+const Hdf5ReaderOptions& Hdf5Reader::options() const {
+    return options_;
+}
+
 HighFive::File Hdf5Reader::openFile(const std::string& filename) const {
     return impl->openFile(filename);
 }
 
+const detail::ReaderResources* detail::readerResources(const Hdf5Reader& reader) {
+    const auto* plugin = dynamic_cast<const Hdf5PluginOptions*>(reader.impl.get());
+    return plugin == nullptr ? nullptr : plugin->resources();
+}
+
+constexpr size_t Hdf5DatasetStatistics::n_latency_buckets;
+
+Hdf5ReaderStatistics::Snapshot Hdf5ReaderStatistics::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+void Hdf5ReaderStatistics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_.clear();
+}
+
+void Hdf5ReaderStatistics::recordRequest(const std::string& dataset, size_t n_elements) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_[dataset].n_elements_requested += n_elements;
+}
+
+void Hdf5ReaderStatistics::recordRead(const std::string& dataset,
+                                      size_t n_elements,
+                                      double seconds) {
+    size_t bucket = 0;
+    double micros = seconds * 1e6;
+    while (micros >= 1.0 && bucket + 1 < Hdf5DatasetStatistics::n_latency_buckets) {
+        micros /= 2.0;
+        ++bucket;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& statistics = statistics_[dataset];
+    statistics.n_read_calls += 1;
+    statistics.n_elements_read += n_elements;
+    statistics.read_seconds += seconds;
+    statistics.latency_histogram[bucket] += 1;
+}
+
+void Hdf5ReaderStatistics::recordCanonicalization(const std::string& dataset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_[dataset].n_canonicalizations += 1;
+}
+
+namespace {
+
+/// Entries of at most `max_bytes` bytes in total, with least recently used
+/// ones evicted first. Not thread-safe by itself.
+template <class KeyTuple>
+struct LruCache {
+    struct Entry {
+        KeyTuple key;
+        std::shared_ptr<const void> value;
+        size_t bytes;
+    };
+    using Index = std::map<KeyTuple, typename std::list<Entry>::iterator>;
+
+    explicit LruCache(size_t max_bytes)
+        : max_bytes(max_bytes) {}
+
+    std::shared_ptr<const void> find(const KeyTuple& key) {
+        const auto it = index.find(key);
+        if (it == index.end()) {
+            ++misses;
+            return nullptr;
+        }
+
+        ++hits;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->value;
+    }
+
+    /// Returns `false`, without inserting anything, if `value` is larger than
+    /// the whole cache.
+    bool insert(KeyTuple key, std::shared_ptr<const void> value, size_t value_bytes) {
+        if (value_bytes > max_bytes) {
+            return false;
+        }
+
+        const auto it = index.find(key);
+        if (it != index.end()) {
+            erase(it);
+        }
+
+        entries.push_front(Entry{key, std::move(value), value_bytes});
+        index.emplace(std::move(key), entries.begin());
+        bytes += value_bytes;
+        while (bytes > max_bytes && !entries.empty()) {
+            bytes -= entries.back().bytes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+        return true;
+    }
+
+    typename Index::iterator erase(typename Index::iterator it) {
+        bytes -= it->second->bytes;
+        entries.erase(it->second);
+        return index.erase(it);
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        bytes = 0;
+    }
+
+    const size_t max_bytes;
+
+    // Most recently used first.
+    std::list<Entry> entries;
+    Index index;
+    size_t bytes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+}  // unnamed namespace
+
+struct Hdf5BlockCache::Impl {
+    using KeyTuple = std::tuple<std::string, std::string, std::string, uint64_t, uint64_t>;
+
+    Impl(size_t max_bytes, size_t block_bytes)
+        : block_bytes(block_bytes)
+        , cache(max_bytes) {}
+
+    static KeyTuple makeKey(const Key& key) {
+        return KeyTuple{key.file, key.dataset, key.type, key.begin, key.end};
+    }
+
+    const size_t block_bytes;
+
+    mutable std::mutex mutex;
+    LruCache<KeyTuple> cache;
+};
+
+Hdf5BlockCache::Hdf5BlockCache(size_t max_bytes, size_t block_bytes)
+    : impl_(new Impl(max_bytes, block_bytes)) {
+    if (block_bytes == 0) {
+        throw SonataError("Hdf5BlockCache: block_bytes must be positive");
+    }
+}
+
+Hdf5BlockCache::~Hdf5BlockCache() = default;
+
+size_t Hdf5BlockCache::maxBytes() const {
+    return impl_->cache.max_bytes;
+}
+
+size_t Hdf5BlockCache::blockBytes() const {
+    return impl_->block_bytes;
+}
+
+size_t Hdf5BlockCache::bytes() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.bytes;
+}
+
+size_t Hdf5BlockCache::hits() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.hits;
+}
+
+size_t Hdf5BlockCache::misses() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.misses;
+}
+
+void Hdf5BlockCache::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->cache.clear();
+}
+
+std::shared_ptr<const void> Hdf5BlockCache::find(const Key& key) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.find(Impl::makeKey(key));
+}
+
+void Hdf5BlockCache::insert(const Key& key, std::shared_ptr<const void> block, size_t bytes) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->cache.insert(Impl::makeKey(key), std::move(block), bytes);
+}
+
+struct Hdf5ColumnCache::Impl {
+    using KeyTuple = std::tuple<std::string, std::string, std::string>;
+
+    explicit Impl(size_t max_bytes)
+        : cache(max_bytes) {}
+
+    static KeyTuple makeKey(const Key& key) {
+        return KeyTuple{key.file, key.dataset, key.type};
+    }
+
+    mutable std::mutex mutex;
+    LruCache<KeyTuple> cache;
+    // The columns which were read but didn't fit in the cache.
+    std::set<KeyTuple> too_large;
+};
+
+Hdf5ColumnCache::Hdf5ColumnCache(size_t max_bytes)
+    : impl_(new Impl(max_bytes)) {}
+
+Hdf5ColumnCache::~Hdf5ColumnCache() = default;
+
+size_t Hdf5ColumnCache::maxBytes() const {
+    return impl_->cache.max_bytes;
+}
+
+size_t Hdf5ColumnCache::bytes() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.bytes;
+}
+
+size_t Hdf5ColumnCache::hits() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.hits;
+}
+
+size_t Hdf5ColumnCache::misses() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.misses;
+}
+
+void Hdf5ColumnCache::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->cache.clear();
+    impl_->too_large.clear();
+}
+
+std::shared_ptr<const void> Hdf5ColumnCache::find(const Key& key) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->cache.find(Impl::makeKey(key));
+}
+
+bool Hdf5ColumnCache::insert(const Key& key, std::shared_ptr<const void> column, size_t bytes) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->cache.insert(Impl::makeKey(key), std::move(column), bytes)) {
+        impl_->too_large.insert(Impl::makeKey(key));
+        return false;
+    }
+    return true;
+}
+
+bool Hdf5ColumnCache::isTooLarge(const Key& key) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->too_large.count(Impl::makeKey(key)) > 0;
+}
+
+void Hdf5ColumnCache::erase(const std::string& file, const std::string& dataset) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto& index = impl_->cache.index;
+    // The types of a column are adjacent in the index, the empty one first.
+    auto it = index.lower_bound(Impl::KeyTuple{file, dataset, std::string()});
+    while (it != index.end() && std::get<0>(it->first) == file &&
+           std::get<1>(it->first) == dataset) {
+        it = impl_->cache.erase(it);
+    }
+
+    auto it_large = impl_->too_large.lower_bound(Impl::KeyTuple{file, dataset, std::string()});
+    while (it_large != impl_->too_large.end() && std::get<0>(*it_large) == file &&
+           std::get<1>(*it_large) == dataset) {
+        it_large = impl_->too_large.erase(it_large);
+    }
+}
+
 }  // namespace sonata
 }  // namespace bbp
@@ -8,38 +8,70 @@ namespace bbp {
 namespace sonata {
 
 namespace detail {
-template <class Range>
-HighFive::HyperSlab _makeHyperslab(const std::vector<Range>& ranges) {
-    HighFive::HyperSlab slab;
-    for (const auto& range : ranges) {
-        size_t i_begin = std::get<0>(range);
-        size_t i_end = std::get<1>(range);
-        slab |= HighFive::RegularHyperSlab({i_begin}, {i_end - i_begin});
+/// Shared by the default plugins, to give all of them access to the options.
+class Hdf5PluginOptions
+{
+  public:
+    explicit Hdf5PluginOptions(const Hdf5ReaderOptions& options = {})
+        : options_(options) {
+        if (options.memory_map) {
+            resources_.mapped_files = std::make_shared<MappedFiles>();
+        }
+        if (options.io_uring_queue_depth > 0) {
+            resources_.io_uring = std::make_shared<IoUringReader>(options.io_uring_queue_depth);
+            if (!resources_.io_uring->available()) {
+                resources_.io_uring = nullptr;
+            }
+        }
+    }
+
+    const Hdf5ReaderOptions& options() const {
+        return options_;
+    }
+
+    /// The memory mapped files and io_uring ring of this plugin, if enabled.
+    const ReaderResources* resources() const {
+        return &resources_;
     }
 
-    return slab;
-}
+  private:
+    Hdf5ReaderOptions options_;
+    ReaderResources resources_;
+};
 }  // namespace detail
 
 
 template <class T>
-class Hdf5PluginRead1DDefault: virtual public Hdf5PluginRead1DInterface<T>
+class Hdf5PluginRead1DDefault: virtual public Hdf5PluginRead1DInterface<T>,
+                               virtual public detail::Hdf5PluginOptions
 {
   public:
     std::vector<T> readSelection(const HighFive::DataSet& dset,
                                  const Selection& selection) const override {
-        return detail::readCanonicalSelection<T>(dset, selection);
+        return detail::readCanonicalSelection<T>(dset,
+                                                 selection,
+                                                 this->options(),
+                                                 this->resources());
+    }
+
+    void readSelectionInto(const HighFive::DataSet& dset,
+                           const Selection& selection,
+                           T* out) const override {
+        detail::readCanonicalSelectionInto<T>(
+            dset, selection, this->options(), out, this->resources());
     }
 };
 
 template <class T>
-class Hdf5PluginRead2DDefault: virtual public Hdf5PluginRead2DInterface<T>
+class Hdf5PluginRead2DDefault: virtual public Hdf5PluginRead2DInterface<T>,
+                               virtual public detail::Hdf5PluginOptions
 {
   public:
     std::vector<T> readSelection(const HighFive::DataSet& dset,
                                  const Selection& xsel,
                                  const Selection& ysel) const override {
-        return detail::readCanonicalSelection<T>(dset, xsel, ysel);
+        return detail::readCanonicalSelection<T>(
+            dset, xsel, ysel, this->options(), this->resources());
     }
 };
 
@@ -53,6 +85,9 @@ class Hdf5PluginDefault<std::tuple<Ts...>, std::tuple<Us...>>
       virtual public Hdf5PluginRead2DDefault<Us>...
 {
   public:
+    explicit Hdf5PluginDefault(const Hdf5ReaderOptions& options = {})
+        : detail::Hdf5PluginOptions(options) {}
+
     HighFive::File openFile(const std::string& path) const override {
         return HighFive::File(path);
     }
@@ -0,0 +1,304 @@
+#include "io_uring_reader.hpp"
+
+#include <bbp/sonata/common.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define SONATA_HAS_IO_URING
+#endif
+#endif
+
+#ifdef SONATA_HAS_IO_URING
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+#endif
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+#ifdef SONATA_HAS_IO_URING
+
+namespace {
+
+// glibc doesn't wrap the io_uring system calls.
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+unsigned* field(void* ring, uint32_t offset) {
+    return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset);
+}
+
+// Linux reads at most this many bytes per call.
+constexpr size_t max_read_bytes = 0x7ffff000;
+
+// Far below the limit of the kernel, and plenty to keep a device busy.
+constexpr size_t max_queue_depth = 4096;
+
+}  // unnamed namespace
+
+struct IoUringReader::Impl {
+    explicit Impl(size_t queue_depth) {
+        io_uring_params params{};
+        const auto entries = std::min(std::max<size_t>(1, queue_depth), max_queue_depth);
+        ring_fd = ioUringSetup(static_cast<unsigned>(entries), &params);
+        if (ring_fd < 0) {
+            return;
+        }
+        depth = params.sq_entries;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_SHARED | MAP_POPULATE;
+        sq_ring = mmap(nullptr, sq_ring_size, prot, flags, ring_fd, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap
+                      ? sq_ring
+                      : mmap(nullptr, cq_ring_size, prot, flags, ring_fd, IORING_OFF_CQ_RING);
+        void* sqes_ring = mmap(nullptr, sqes_size, prot, flags, ring_fd, IORING_OFF_SQES);
+        if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes_ring == MAP_FAILED) {
+            if (sqes_ring != MAP_FAILED) {
+                munmap(sqes_ring, sqes_size);
+            }
+            release();
+            return;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqes_ring);
+
+        sq_head = field(sq_ring, params.sq_off.head);
+        sq_tail = field(sq_ring, params.sq_off.tail);
+        sq_mask = *field(sq_ring, params.sq_off.ring_mask);
+        sq_array = field(sq_ring, params.sq_off.array);
+        cq_head = field(cq_ring, params.cq_off.head);
+        cq_tail = field(cq_ring, params.cq_off.tail);
+        cq_mask = *field(cq_ring, params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(cq_ring) + params.cq_off.cqes);
+    }
+
+    ~Impl() {
+        for (const auto& file : files) {
+            close(file.second);
+        }
+        if (sqes != nullptr) {
+            munmap(sqes, sqes_size);
+        }
+        release();
+    }
+
+    void release() {
+        if (cq_ring != MAP_FAILED && !single_mmap) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        sq_ring = cq_ring = MAP_FAILED;
+        if (ring_fd >= 0) {
+            close(ring_fd);
+        }
+        ring_fd = -1;
+    }
+
+    /// The descriptor of `path`, opened once.
+    int file(const std::string& path) {
+        const auto it = files.find(path);
+        if (it != files.end()) {
+            return it->second;
+        }
+
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw SonataError(fmt::format("Can't open '{}': {}", path, std::strerror(errno)));
+        }
+        files.emplace(path, fd);
+        return fd;
+    }
+
+    std::mutex mutex;
+    int ring_fd = -1;
+    unsigned depth = 0;
+    bool single_mmap = false;
+
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    std::map<std::string, int> files;
+};
+
+IoUringReader::IoUringReader(size_t queue_depth)
+    : impl_(new Impl(queue_depth)) {}
+
+IoUringReader::~IoUringReader() = default;
+
+bool IoUringReader::available() const {
+    return impl_->ring_fd >= 0;
+}
+
+void IoUringReader::read(const std::string& path, const std::vector<Request>& requests) {
+    auto& ring = *impl_;
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    if (ring.ring_fd < 0) {
+        throw SonataError("io_uring isn't available");
+    }
+    const int fd = ring.file(path);
+
+    // What remains to be read of each request; short reads are resubmitted.
+    std::vector<Request> remaining;
+    std::deque<size_t> todo;
+    for (const auto& request : requests) {
+        if (request.size > 0) {
+            todo.push_back(remaining.size());
+            remaining.push_back(request);
+        }
+    }
+    std::vector<iovec> iovecs(remaining.size());
+
+    size_t n_done = 0;
+    size_t n_in_flight = 0;
+    // Set on the first failure; reads still in flight are awaited before throwing.
+    std::string error;
+    // Set once `io_uring_enter` fails for good; completions are then polled.
+    bool enter_failed = false;
+    while (n_in_flight > 0 || (error.empty() && n_done < remaining.size())) {
+        unsigned tail = *ring.sq_tail;
+        while (error.empty() && !todo.empty() && n_in_flight < ring.depth) {
+            const size_t i = todo.front();
+            todo.pop_front();
+
+            iovecs[i].iov_base = remaining[i].out;
+            iovecs[i].iov_len = std::min(remaining[i].size, max_read_bytes);
+
+            const unsigned index = tail & ring.sq_mask;
+            io_uring_sqe& sqe = ring.sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = fd;
+            sqe.off = remaining[i].offset;
+            sqe.addr = reinterpret_cast<uint64_t>(&iovecs[i]);
+            sqe.len = 1;
+            sqe.user_data = i;
+            ring.sq_array[index] = index;
+
+            ++tail;
+            ++n_in_flight;
+        }
+        __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+
+        // Entries the kernel hasn't consumed yet, e.g. after an interrupt.
+        const unsigned sq_head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+        const unsigned to_submit = tail - sq_head;
+        if (!enter_failed &&
+            ioUringEnter(ring.ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            // Withdraw the entries which didn't reach the kernel, so that no
+            // buffer is written after returning. The reads which did still
+            // complete, without retrying the call, which would fail again.
+            if (error.empty()) {
+                error = fmt::format("io_uring_enter failed: {}", std::strerror(errno));
+            }
+            const unsigned consumed = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+            __atomic_store_n(ring.sq_tail, consumed, __ATOMIC_RELEASE);
+            n_in_flight -= tail - consumed;
+            enter_failed = true;
+        }
+
+        unsigned head = *ring.cq_head;
+        const unsigned cq_tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        if (enter_failed && head == cq_tail && n_in_flight > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        for (; head != cq_tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+            const size_t i = cqe.user_data;
+            --n_in_flight;
+
+            if (cqe.res <= 0) {
+                if (error.empty()) {
+                    error = cqe.res < 0 ? std::strerror(-cqe.res) : "unexpected end of file";
+                }
+                continue;
+            }
+
+            const auto n_bytes = static_cast<size_t>(cqe.res);
+            remaining[i].offset += n_bytes;
+            remaining[i].out += n_bytes;
+            remaining[i].size -= n_bytes;
+            if (remaining[i].size > 0) {
+                todo.push_back(i);
+            } else {
+                ++n_done;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if (!error.empty()) {
+        throw SonataError(fmt::format("Failed to read '{}': {}", path, error));
+    }
+}
+
+#else
+
+struct IoUringReader::Impl {};
+
+IoUringReader::IoUringReader(size_t) {}
+
+IoUringReader::~IoUringReader() = default;
+
+bool IoUringReader::available() const {
+    return false;
+}
+
+void IoUringReader::read(const std::string&, const std::vector<Request>&) {
+    throw SonataError("io_uring isn't available");
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+/// Reads blocks of files with Linux io_uring, submitting a whole batch at once.
+///
+/// Not available on other systems, or if the kernel refuses to create a
+/// ring, e.g. because io_uring is disabled.
+class IoUringReader
+{
+  public:
+    /// One block of `size` bytes at `offset` in the file, read into `out`.
+    struct Request {
+        size_t offset;
+        size_t size;
+        char* out;
+    };
+
+    /// A ring with up to `queue_depth` reads in flight, at most 4096.
+    explicit IoUringReader(size_t queue_depth);
+    ~IoUringReader();
+
+    IoUringReader(const IoUringReader&) = delete;
+    IoUringReader& operator=(const IoUringReader&) = delete;
+
+    bool available() const;
+
+    /// Read all `requests` from the file `path`, which is opened once and
+    /// kept open until the reader is destroyed. Requires `available()`.
+    ///
+    /// \throw SonataError if the file can't be opened or any read fails
+    void read(const std::string& path, const std::vector<Request>& requests);
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
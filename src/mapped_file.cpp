@@ -0,0 +1,78 @@
+#include "mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+#ifdef _WIN32
+    (void) path;
+    return nullptr;
+#else
+    // Readers of the same file share one mapping, as long as any of them holds it.
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const MappedFile>> mapped;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto file = mapped[path].lock()) {
+        return file;
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info {};
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // The mapping remains valid after closing the file.
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const MappedFile> file(
+        new MappedFile(static_cast<const char*>(data), static_cast<size_t>(info.st_size)));
+    // Forget the files which aren't mapped anymore.
+    for (auto it = mapped.begin(); it != mapped.end();) {
+        if (it->second.expired()) {
+            it = mapped.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    mapped[path] = file;
+    return file;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    ::munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFiles::get(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& file = files_[path];
+    if (file == nullptr) {
+        file = MappedFile::open(path);
+    }
+    return file;
+}
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
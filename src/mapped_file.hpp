@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+
+namespace bbp {
+namespace sonata {
+namespace detail {
+
+/// A file mapped read-only into memory.
+class MappedFile
+{
+  public:
+    /// A read-only mapping of the whole file `path`, shared with all other
+    /// current mappings of `path`; `nullptr` if the file can't be mapped.
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    MappedFile(const char* data, size_t size)
+        : data_(data)
+        , size_(size) {}
+
+    const char* data_;
+    size_t size_;
+};
+
+/// Keeps the files mapped by one reader alive until the reader is destroyed.
+class MappedFiles
+{
+  public:
+    /// The mapping of `path`, see `MappedFile::open`.
+    std::shared_ptr<const MappedFile> get(const std::string& path);
+
+  private:
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<const MappedFile>> files_;
+};
+
+}  // namespace detail
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,682 @@
+#include <bbp/sonata/mpi/hdf5_reader.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>  // strnlen
+#include <exception>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+#include <hdf5.h>
+
+#include "../read_canonical_selection.hpp"
+
+namespace bbp {
+namespace sonata {
+namespace mpi {
+
+namespace {
+
+void check(herr_t err, const char* what) {
+    if (err < 0) {
+        throw SonataError(fmt::format("Failed to {}", what));
+    }
+}
+
+/// Owns an HDF5 identifier, which is released by `close`.
+class Hid
+{
+  public:
+    Hid(hid_t id, herr_t (*close)(hid_t), const char* what)
+        : id_(id)
+        , close_(close) {
+        if (id < 0) {
+            throw SonataError(fmt::format("Failed to {}", what));
+        }
+    }
+
+    ~Hid() {
+        close_(id_);
+    }
+
+    Hid(const Hid&) = delete;
+    Hid& operator=(const Hid&) = delete;
+
+    hid_t get() const {
+        return id_;
+    }
+
+  private:
+    hid_t id_;
+    herr_t (*close_)(hid_t);
+};
+
+template <class T>
+hid_t nativeType() {
+    static_assert(std::is_arithmetic<T>::value, "Only numeric types have a native HDF5 type.");
+    if (std::is_floating_point<T>::value) {
+        return sizeof(T) == sizeof(float) ? H5T_NATIVE_FLOAT : H5T_NATIVE_DOUBLE;
+    }
+
+    const bool is_signed = std::is_signed<T>::value;
+    switch (sizeof(T)) {
+    case 1:
+        return is_signed ? H5T_NATIVE_INT8 : H5T_NATIVE_UINT8;
+    case 2:
+        return is_signed ? H5T_NATIVE_INT16 : H5T_NATIVE_UINT16;
+    case 4:
+        return is_signed ? H5T_NATIVE_INT32 : H5T_NATIVE_UINT32;
+    default:
+        return is_signed ? H5T_NATIVE_INT64 : H5T_NATIVE_UINT64;
+    }
+}
+
+/// Read the `n_values` selected values with one `H5Dread`.
+template <class T>
+void readValues(hid_t dset, hid_t mem_space, hid_t file_space, hid_t dxpl, size_t, T* out) {
+    // Ranks with an empty selection still take part in collective reads.
+    T dummy{};
+    check(H5Dread(dset, nativeType<T>(), mem_space, file_space, dxpl, out ? out : &dummy),
+          "read the dataset");
+}
+
+void readValues(
+    hid_t dset, hid_t mem_space, hid_t file_space, hid_t dxpl, size_t n_values, std::string* out) {
+    const Hid file_type(H5Dget_type(dset), H5Tclose, "get the datatype");
+    const htri_t is_variable = H5Tis_variable_str(file_type.get());
+    check(is_variable, "query the string type");
+
+    if (is_variable > 0) {
+        const Hid mem_type(H5Tcopy(H5T_C_S1), H5Tclose, "create the string type");
+        check(H5Tset_size(mem_type.get(), H5T_VARIABLE), "create the string type");
+        check(H5Tset_cset(mem_type.get(), H5Tget_cset(file_type.get())),
+              "create the string type");
+
+        std::vector<char*> buffer(std::max<size_t>(n_values, 1), nullptr);
+        check(H5Dread(dset, mem_type.get(), mem_space, file_space, dxpl, buffer.data()),
+              "read the dataset");
+        for (size_t i = 0; i < n_values; ++i) {
+            out[i] = buffer[i] != nullptr ? buffer[i] : "";
+        }
+        check(H5Dvlen_reclaim(mem_type.get(), mem_space, H5P_DEFAULT, buffer.data()),
+              "release the strings");
+        return;
+    }
+
+    const size_t size = H5Tget_size(file_type.get());
+    std::vector<char> buffer(std::max<size_t>(n_values * size, 1));
+    check(H5Dread(dset, file_type.get(), mem_space, file_space, dxpl, buffer.data()),
+          "read the dataset");
+    for (size_t i = 0; i < n_values; ++i) {
+        const char* value = buffer.data() + i * size;
+        out[i].assign(value, strnlen(value, size));
+    }
+}
+
+/// Read the rows `xranges` of `dset` with a single `H5Dread`.
+///
+/// For two-dimensional datasets, `yranges` are the columns to read and the
+/// values are written in row-major order.
+template <class T>
+void readHyperslabInto(const HighFive::DataSet& dset,
+                       const Selection::Ranges& xranges,
+                       const Selection::Ranges* yranges,
+                       bool collective,
+                       T* out) {
+    const Hid file_space(H5Dget_space(dset.getId()), H5Sclose, "get the dataspace");
+    check(H5Sselect_none(file_space.get()), "select the values");
+
+    auto select = [&file_space](const hsize_t* start, const hsize_t* count) {
+        check(H5Sselect_hyperslab(file_space.get(), H5S_SELECT_OR, start, nullptr, count, nullptr),
+              "select the values");
+    };
+
+    size_t n_values = 0;
+    for (const auto& xrange : xranges) {
+        const hsize_t n_rows = std::get<1>(xrange) - std::get<0>(xrange);
+        if (n_rows == 0) {
+            continue;
+        }
+
+        if (yranges == nullptr) {
+            const hsize_t start[] = {std::get<0>(xrange)};
+            const hsize_t count[] = {n_rows};
+            select(start, count);
+            n_values += n_rows;
+            continue;
+        }
+
+        for (const auto& yrange : *yranges) {
+            const hsize_t n_cols = std::get<1>(yrange) - std::get<0>(yrange);
+            if (n_cols == 0) {
+                continue;
+            }
+            const hsize_t start[] = {std::get<0>(xrange), std::get<0>(yrange)};
+            const hsize_t count[] = {n_rows, n_cols};
+            select(start, count);
+            n_values += n_rows * n_cols;
+        }
+    }
+
+    const hsize_t mem_size = std::max<size_t>(n_values, 1);
+    const Hid mem_space(H5Screate_simple(1, &mem_size, nullptr), H5Sclose, "create a dataspace");
+    if (n_values == 0) {
+        check(H5Sselect_none(mem_space.get()), "select the values");
+    }
+
+    const Hid dxpl(H5Pcreate(H5P_DATASET_XFER), H5Pclose, "create a transfer property list");
+    check(H5Pset_dxpl_mpio(dxpl.get(), collective ? H5FD_MPIO_COLLECTIVE : H5FD_MPIO_INDEPENDENT),
+          "set the MPI-IO transfer mode");
+
+    readValues(dset.getId(), mem_space.get(), file_space.get(), dxpl.get(), n_values, out);
+}
+
+/// HighFive file access property selecting the MPI-IO driver.
+class MPIOFileAccess
+{
+  public:
+    MPIOFileAccess(MPI_Comm comm, const CollectiveReaderOptions& options)
+        : comm_(comm)
+        , options_(options) {}
+
+    void apply(hid_t fapl) const {
+        MPI_Info info = MPI_INFO_NULL;
+        if (options_.collective_transfer && options_.two_phase_aggregation) {
+            // ROMIO's collective buffering is two-phase I/O.
+            MPI_Info_create(&info);
+            MPI_Info_set(info, "romio_cb_read", "enable");
+            if (options_.n_aggregators > 0) {
+                MPI_Info_set(info, "cb_nodes", std::to_string(options_.n_aggregators).c_str());
+            }
+        }
+
+        const auto err = H5Pset_fapl_mpio(fapl, comm_, info);
+        if (info != MPI_INFO_NULL) {
+            MPI_Info_free(&info);
+        }
+        check(err, "select the MPI-IO file driver");
+
+        if (options_.collective_metadata) {
+            check(H5Pset_all_coll_metadata_ops(fapl, true), "enable collective metadata reads");
+            check(H5Pset_coll_metadata_write(fapl, true), "enable collective metadata writes");
+        }
+    }
+
+  private:
+    MPI_Comm comm_;
+    CollectiveReaderOptions options_;
+};
+
+/// Shared by the MPI plugins, to give all of them access to the communicator.
+class Hdf5PluginMPIContext
+{
+  public:
+    explicit Hdf5PluginMPIContext(MPI_Comm comm = MPI_COMM_WORLD,
+                                  const CollectiveReaderOptions& options = {})
+        : comm_(comm)
+        , options_(options) {}
+
+    MPI_Comm comm() const {
+        return comm_;
+    }
+
+    const CollectiveReaderOptions& options() const {
+        return options_;
+    }
+
+  private:
+    MPI_Comm comm_;
+    CollectiveReaderOptions options_;
+};
+
+template <class T>
+class Hdf5PluginRead1DMPI: virtual public Hdf5PluginRead1DInterface<T>,
+                           virtual public Hdf5PluginMPIContext
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        std::vector<T> values(selection.flatSize());
+        readSelectionInto(dset, selection, values.data());
+        return values;
+    }
+
+    void readSelectionInto(const HighFive::DataSet& dset,
+                           const Selection& selection,
+                           T* out) const override {
+        // HDF5 breaks collective reads of variable-length strings into
+        // independent ones; strings are hence always read independently.
+        const bool collective = options().collective_transfer &&
+                                !std::is_same<T, std::string>::value;
+        readHyperslabInto(dset, selection.ranges(), nullptr, collective, out);
+    }
+};
+
+template <class T>
+class Hdf5PluginRead2DMPI: virtual public Hdf5PluginRead2DInterface<T>,
+                           virtual public Hdf5PluginMPIContext
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& xsel,
+                                 const Selection& ysel) const override {
+        using Element = typename detail::Element2D<T>::type;
+        constexpr size_t n_elements = detail::Element2D<T>::size;
+
+        const size_t n_values = xsel.flatSize() * ysel.flatSize();
+        if (n_values % n_elements != 0) {
+            throw SonataError(
+                fmt::format("Can't read {} values into groups of {}.", n_values, n_elements));
+        }
+
+        std::vector<T> values(n_values / n_elements);
+        readHyperslabInto(dset,
+                          xsel.ranges(),
+                          &ysel.ranges(),
+                          options().collective_transfer,
+                          reinterpret_cast<Element*>(values.data()));
+        return values;
+    }
+};
+
+template <class T, class U>
+class Hdf5PluginMPI;
+
+template <class... Ts, class... Us>
+class Hdf5PluginMPI<std::tuple<Ts...>, std::tuple<Us...>>
+    : virtual public Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>,
+      virtual public Hdf5PluginRead1DMPI<Ts>...,
+      virtual public Hdf5PluginRead2DMPI<Us>...
+{
+  public:
+    Hdf5PluginMPI(MPI_Comm comm, const CollectiveReaderOptions& options)
+        : Hdf5PluginMPIContext(comm, options) {}
+
+    HighFive::File openFile(const std::string& path) const override {
+        HighFive::FileAccessProps fapl;
+        fapl.add(MPIOFileAccess(this->comm(), this->options()));
+        return HighFive::File(path, HighFive::File::ReadOnly, fapl);
+    }
+};
+
+int checkedCount(size_t count) {
+    if (count > static_cast<size_t>(INT_MAX)) {
+        throw SonataError(fmt::format("Can't send {} values in one MPI message.", count));
+    }
+    return static_cast<int>(count);
+}
+
+std::vector<int> displacements(const std::vector<int>& counts) {
+    std::vector<int> displs(counts.size(), 0);
+    for (size_t i = 1; i < counts.size(); ++i) {
+        displs[i] = checkedCount(static_cast<size_t>(displs[i - 1]) +
+                                 static_cast<size_t>(counts[i - 1]));
+    }
+    return displs;
+}
+
+/// MPI datatype of `bytes` contiguous bytes.
+class ContiguousType
+{
+  public:
+    explicit ContiguousType(size_t bytes) {
+        MPI_Type_contiguous(checkedCount(bytes), MPI_BYTE, &type_);
+        MPI_Type_commit(&type_);
+    }
+
+    ~ContiguousType() {
+        MPI_Type_free(&type_);
+    }
+
+    ContiguousType(const ContiguousType&) = delete;
+    ContiguousType& operator=(const ContiguousType&) = delete;
+
+    MPI_Datatype get() const {
+        return type_;
+    }
+
+  private:
+    MPI_Datatype type_;
+};
+
+/// The `ranges` of every rank of `comm`, on rank `0`; empty on all other ranks.
+std::vector<Selection> gatherRanges(MPI_Comm comm, const Selection::Ranges& ranges) {
+    int rank = 0;
+    int size = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    std::vector<uint64_t> flat;
+    flat.reserve(2 * ranges.size());
+    for (const auto& range : ranges) {
+        flat.push_back(std::get<0>(range));
+        flat.push_back(std::get<1>(range));
+    }
+
+    int count = checkedCount(flat.size());
+    std::vector<int> counts(rank == 0 ? size : 0);
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+
+    const auto displs = displacements(counts);
+    std::vector<uint64_t> all(counts.empty() ? 0 : displs.back() + counts.back());
+    MPI_Gatherv(flat.data(),
+                count,
+                MPI_UINT64_T,
+                all.data(),
+                counts.data(),
+                displs.data(),
+                MPI_UINT64_T,
+                0,
+                comm);
+
+    std::vector<Selection> selections;
+    selections.reserve(counts.size());
+    for (size_t i = 0; i < counts.size(); ++i) {
+        Selection::Ranges rank_ranges;
+        for (int k = displs[i]; k < displs[i] + counts[i]; k += 2) {
+            rank_ranges.push_back({all[k], all[k + 1]});
+        }
+        selections.emplace_back(std::move(rank_ranges));
+    }
+    return selections;
+}
+
+/// Offset of each of the `inner` ranges in the flattened `outer` ranges.
+///
+/// Both are canonical and every `inner` range is contained in one `outer` range.
+std::vector<size_t> offsetsIn(const Selection::Ranges& outer, const Selection::Ranges& inner) {
+    std::vector<size_t> offsets;
+    offsets.reserve(inner.size());
+
+    size_t i = 0;
+    size_t outer_offset = 0;
+    for (const auto& range : inner) {
+        if (std::get<0>(range) == std::get<1>(range)) {
+            offsets.push_back(0);
+            continue;
+        }
+        while (std::get<1>(outer[i]) <= std::get<0>(range)) {
+            outer_offset += std::get<1>(outer[i]) - std::get<0>(outer[i]);
+            ++i;
+        }
+        offsets.push_back(outer_offset + std::get<0>(range) - std::get<0>(outer[i]));
+    }
+    return offsets;
+}
+
+/// Run `read` on rank `0` of `comm` and let all ranks fail if it throws.
+template <class F>
+void readOnAggregator(MPI_Comm comm, F read) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    std::exception_ptr error;
+    if (rank == 0) {
+        try {
+            read();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    int failed = error ? 1 : 0;
+    MPI_Bcast(&failed, 1, MPI_INT, 0, comm);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (failed != 0) {
+        throw SonataError("The aggregator failed to read the selection.");
+    }
+}
+
+/// Send `counts[i]` consecutive values of `values` from rank `0` to rank `i`,
+/// which receives its `n_values` values in `out`.
+template <class T>
+void scatterValues(MPI_Comm comm,
+                   const std::vector<T>& values,
+                   const std::vector<int>& counts,
+                   size_t n_values,
+                   T* out) {
+    const ContiguousType type(sizeof(T));
+    const auto displs = displacements(counts);
+    MPI_Scatterv(values.data(),
+                 counts.data(),
+                 displs.data(),
+                 type.get(),
+                 out,
+                 checkedCount(n_values),
+                 type.get(),
+                 0,
+                 comm);
+}
+
+void scatterValues(MPI_Comm comm,
+                   const std::vector<std::string>& values,
+                   const std::vector<int>& counts,
+                   size_t n_values,
+                   std::string* out) {
+    std::vector<uint64_t> sizes;
+    sizes.reserve(values.size());
+    std::vector<int> char_counts;
+    char_counts.reserve(counts.size());
+    std::string chars;
+
+    auto value = values.begin();
+    for (const auto count : counts) {
+        size_t n_chars = 0;
+        for (int i = 0; i < count; ++i, ++value) {
+            sizes.push_back(value->size());
+            chars += *value;
+            n_chars += value->size();
+        }
+        char_counts.push_back(checkedCount(n_chars));
+    }
+
+    std::vector<uint64_t> local_sizes(n_values);
+    scatterValues(comm, sizes, counts, n_values, local_sizes.data());
+
+    std::string local_chars(std::accumulate(local_sizes.begin(), local_sizes.end(), size_t(0)),
+                            '\0');
+    const auto displs = displacements(char_counts);
+    MPI_Scatterv(chars.data(),
+                 char_counts.data(),
+                 displs.data(),
+                 MPI_CHAR,
+                 &local_chars[0],
+                 checkedCount(local_chars.size()),
+                 MPI_CHAR,
+                 0,
+                 comm);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < n_values; ++i) {
+        out[i] = local_chars.substr(offset, local_sizes[i]);
+        offset += local_sizes[i];
+    }
+}
+
+/// Shared by the aggregating plugins: the ranks of one group and the reader
+/// used by their aggregator.
+class Hdf5PluginAggregatorContext
+{
+  public:
+    explicit Hdf5PluginAggregatorContext(MPI_Comm group = MPI_COMM_NULL,
+                                         const Hdf5ReaderOptions& options = {})
+        : group_(group)
+        , reader_(options) {}
+
+    ~Hdf5PluginAggregatorContext() {
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (group_ != MPI_COMM_NULL && finalized == 0) {
+            MPI_Comm_free(&group_);
+        }
+    }
+
+    Hdf5PluginAggregatorContext(const Hdf5PluginAggregatorContext&) = delete;
+    Hdf5PluginAggregatorContext& operator=(const Hdf5PluginAggregatorContext&) = delete;
+
+    MPI_Comm group() const {
+        return group_;
+    }
+
+    const Hdf5Reader& reader() const {
+        return reader_;
+    }
+
+  private:
+    MPI_Comm group_;
+    Hdf5Reader reader_;
+};
+
+template <class T>
+class Hdf5PluginRead1DAggregator: virtual public Hdf5PluginRead1DInterface<T>,
+                                  virtual public Hdf5PluginAggregatorContext
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        std::vector<T> values(selection.flatSize());
+        readSelectionInto(dset, selection, values.data());
+        return values;
+    }
+
+    void readSelectionInto(const HighFive::DataSet& dset,
+                           const Selection& selection,
+                           T* out) const override {
+        const auto selections = gatherRanges(group(), selection.ranges());
+
+        std::vector<T> send;
+        std::vector<int> counts;
+        readOnAggregator(group(), [&]() {
+            const auto all = Selection::unionAll(selections);
+            const auto values = reader().template readSelection<T>(dset, all);
+
+            send.reserve(std::accumulate(
+                selections.begin(), selections.end(), size_t(0), [](size_t n, const Selection& s) {
+                    return n + s.flatSize();
+                }));
+            for (const auto& rank_selection : selections) {
+                const auto& ranges = rank_selection.ranges();
+                const auto offsets = offsetsIn(all.ranges(), ranges);
+                for (size_t i = 0; i < ranges.size(); ++i) {
+                    const auto first = values.begin() + static_cast<ptrdiff_t>(offsets[i]);
+                    const auto n = std::get<1>(ranges[i]) - std::get<0>(ranges[i]);
+                    send.insert(send.end(), first, first + static_cast<ptrdiff_t>(n));
+                }
+                counts.push_back(checkedCount(rank_selection.flatSize()));
+            }
+        });
+
+        scatterValues(group(), send, counts, selection.flatSize(), out);
+    }
+};
+
+template <class T>
+class Hdf5PluginRead2DAggregator: virtual public Hdf5PluginRead2DInterface<T>,
+                                  virtual public Hdf5PluginAggregatorContext
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& xsel,
+                                 const Selection& ysel) const override {
+        using Element = typename detail::Element2D<T>::type;
+        constexpr size_t n_elements = detail::Element2D<T>::size;
+
+        const size_t n_values = xsel.flatSize() * ysel.flatSize();
+        if (n_values % n_elements != 0) {
+            throw SonataError(
+                fmt::format("Can't read {} values into groups of {}.", n_values, n_elements));
+        }
+
+        const auto xselections = gatherRanges(group(), xsel.ranges());
+        const auto yselections = gatherRanges(group(), ysel.ranges());
+
+        std::vector<Element> send;
+        std::vector<int> counts;
+        readOnAggregator(group(), [&]() {
+            const auto xall = Selection::unionAll(xselections);
+            const auto yall = Selection::unionAll(yselections);
+            const auto values = reader().template readSelection<T>(dset, xall, yall);
+            const auto* elements = reinterpret_cast<const Element*>(values.data());
+            const size_t n_cols = yall.flatSize();
+
+            for (size_t r = 0; r < xselections.size(); ++r) {
+                const auto& xranges = xselections[r].ranges();
+                const auto& yranges = yselections[r].ranges();
+                const auto xoffsets = offsetsIn(xall.ranges(), xranges);
+                const auto yoffsets = offsetsIn(yall.ranges(), yranges);
+
+                for (size_t i = 0; i < xranges.size(); ++i) {
+                    const auto n_rows = std::get<1>(xranges[i]) - std::get<0>(xranges[i]);
+                    for (size_t row = xoffsets[i]; row < xoffsets[i] + n_rows; ++row) {
+                        for (size_t j = 0; j < yranges.size(); ++j) {
+                            const auto* first = elements + row * n_cols + yoffsets[j];
+                            send.insert(send.end(),
+                                        first,
+                                        first + (std::get<1>(yranges[j]) -
+                                                 std::get<0>(yranges[j])));
+                        }
+                    }
+                }
+                counts.push_back(
+                    checkedCount(xselections[r].flatSize() * yselections[r].flatSize()));
+            }
+        });
+
+        std::vector<T> values(n_values / n_elements);
+        scatterValues(group(), send, counts, n_values, reinterpret_cast<Element*>(values.data()));
+        return values;
+    }
+};
+
+template <class T, class U>
+class Hdf5PluginAggregator;
+
+template <class... Ts, class... Us>
+class Hdf5PluginAggregator<std::tuple<Ts...>, std::tuple<Us...>>
+    : virtual public Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>,
+      virtual public Hdf5PluginRead1DAggregator<Ts>...,
+      virtual public Hdf5PluginRead2DAggregator<Us>...
+{
+  public:
+    Hdf5PluginAggregator(MPI_Comm group, const Hdf5ReaderOptions& options)
+        : Hdf5PluginAggregatorContext(group, options) {}
+
+    HighFive::File openFile(const std::string& path) const override {
+        return this->reader().openFile(path);
+    }
+};
+
+}  // unnamed namespace
+
+Hdf5Reader makeCollectiveReader(MPI_Comm comm, const CollectiveReaderOptions& options) {
+    return Hdf5Reader(
+        std::make_shared<
+            Hdf5PluginMPI<Hdf5Reader::supported_1D_types, Hdf5Reader::supported_2D_types>>(
+            comm, options));
+}
+
+Hdf5Reader makeAggregatingReader(MPI_Comm comm, const AggregatingReaderOptions& options) {
+    if (options.group_size < 1) {
+        throw SonataError(
+            fmt::format("The group size must be positive, got {}.", options.group_size));
+    }
+
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm group = MPI_COMM_NULL;
+    MPI_Comm_split(comm, rank / options.group_size, rank, &group);
+
+    return Hdf5Reader(
+        std::make_shared<
+            Hdf5PluginAggregator<Hdf5Reader::supported_1D_types, Hdf5Reader::supported_2D_types>>(
+            group, options.reader));
+}
+
+}  // namespace mpi
+}  // namespace sonata
+}  // namespace bbp
@@ -259,11 +259,12 @@ class NodeSetBasicMultiClause: public NodeSetRule
         : clauses_(std::move(clauses)) {}
 
     Selection materialize(const detail::NodeSets& ns, const NodePopulation& np) const final {
-        Selection ret = np.selectAll();
+        std::vector<Selection> selections{np.selectAll()};
+        selections.reserve(clauses_.size() + 1);
         for (const auto& clause : clauses_) {
-            ret = ret & clause->materialize(ns, np);
+            selections.push_back(clause->materialize(ns, np));
         }
-        return ret;
+        return Selection::intersectAll(selections);
     }
 
     std::string toJSON() const final {
@@ -435,11 +436,12 @@ class NodeSetCompoundRule: public NodeSetRule
         , targets_(std::move(targets)) {}
 
     Selection materialize(const detail::NodeSets& ns, const NodePopulation& np) const final {
-        Selection ret{{}};
+        std::vector<Selection> selections;
+        selections.reserve(targets_.size());
         for (const auto& target : targets_) {
-            ret = ret | ns.materialize(target, np);
+            selections.push_back(ns.materialize(target, np));
         }
-        return ret;
+        return Selection::unionAll(selections);
     }
 
     std::string toJSON() const final {
@@ -669,7 +671,7 @@ Selection NodeSets::materialize(const std::string& name, const NodePopulation& p
     // (ie: a whole hierarchy of regions), all checking the same attribute
     // rather than `materializing` them separately, we group them, and materialize
     // them all at once
-    Selection ret{{}};
+    std::vector<Selection> selections;
 
     std::vector<NodeSetRule*> queue{ns.get()};
     std::map<std::string, std::set<std::string>> attribute2rule_strings;
@@ -705,24 +707,24 @@ Selection NodeSets::materialize(const std::string& name, const NodePopulation& p
                     }
                 }
 
-                ret = ret | ns->materialize(*this, population);
+                selections.push_back(ns->materialize(*this, population));
             }
         } else {
-            ret = ret | ns->materialize(*this, population);
+            selections.push_back(ns->materialize(*this, population));
         }
     }
 
     for (const auto& it : attribute2rule_strings) {
         std::vector<std::string> values(it.second.begin(), it.second.end());
-        ret = ret | population.matchAttributeValues(it.first, values);
+        selections.push_back(population.matchAttributeValues(it.first, values));
     }
 
     for (const auto& it : attribute2rule_int64) {
         std::vector<int64_t> values(it.second.begin(), it.second.end());
-        ret = ret | population.matchAttributeValues(it.first, values);
+        selections.push_back(population.matchAttributeValues(it.first, values));
     }
 
-    return ret;
+    return Selection::unionAll(selections);
 }
 }  // namespace detail
 
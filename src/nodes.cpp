@@ -43,17 +43,15 @@ Selection _matchAttributeValues(const NodePopulation& population,
     }
 }
 
-bool is_unsigned_int(const HighFive::DataType& dtype) {
-    return dtype == HighFive::AtomicType<uint8_t>() || dtype == HighFive::AtomicType<uint16_t>() ||
-           dtype == HighFive::AtomicType<uint32_t>() || dtype == HighFive::AtomicType<uint64_t>();
+bool is_unsigned_int(const std::string& dtype) {
+    return dtype == "uint8_t" || dtype == "uint16_t" || dtype == "uint32_t" || dtype == "uint64_t";
 }
 
-bool is_signed_int(const HighFive::DataType& dtype) {
-    return dtype == HighFive::AtomicType<int8_t>() || dtype == HighFive::AtomicType<int16_t>() ||
-           dtype == HighFive::AtomicType<int32_t>() || dtype == HighFive::AtomicType<int64_t>();
+bool is_signed_int(const std::string& dtype) {
+    return dtype == "int8_t" || dtype == "int16_t" || dtype == "int32_t" || dtype == "int64_t";
 }
-bool is_floating(const HighFive::DataType& dtype) {
-    return dtype == HighFive::AtomicType<float>() || dtype == HighFive::AtomicType<double>();
+bool is_floating(const std::string& dtype) {
+    return dtype == "float" || dtype == "double";
 }
 
 template <typename UnaryPredicate>
@@ -117,7 +115,7 @@ Selection NodePopulation::matchAttributeValues(const std::string& attribute,
         throw SonataError("Matching a @library enum by non-string");
     }
 
-    auto dtype = impl_->getAttributeDataSet(attribute).getDataType();
+    const auto& dtype = impl_->getAttributeInfo(attribute).dtype;
     if (is_unsigned_int(dtype) || is_signed_int(dtype)) {
         return _matchAttributeValues<T>(*this, attribute, values);
     } else if (is_floating(dtype)) {
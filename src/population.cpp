@@ -8,6 +8,9 @@
  *************************************************************************/
 
 #include <algorithm>  // std::copy, std::sort, std::max, std::min
+#include <cstddef>    // std::ptrdiff_t
+#include <memory>     // std::make_shared, std::static_pointer_cast
+#include <typeinfo>   // typeid
 #include <utility>    // std::move
 
 #include "hdf5_mutex.hpp"
@@ -18,39 +21,112 @@
 
 #include "population.hpp"
 #include "read_bulk.hpp"
+#include "read_canonical_selection.hpp"
 
 namespace bbp {
 namespace sonata {
 
 namespace {
 
-std::string _getDataType(const HighFive::DataSet& dset, const std::string& name) {
-    const auto dtype = dset.getDataType();
-    if (dtype == HighFive::AtomicType<int8_t>()) {
-        return "int8_t";
-    } else if (dtype == HighFive::AtomicType<uint8_t>()) {
-        return "uint8_t";
-    } else if (dtype == HighFive::AtomicType<int16_t>()) {
-        return "int16_t";
-    } else if (dtype == HighFive::AtomicType<uint16_t>()) {
-        return "uint16_t";
-    } else if (dtype == HighFive::AtomicType<int32_t>()) {
-        return "int32_t";
-    } else if (dtype == HighFive::AtomicType<uint32_t>()) {
-        return "uint32_t";
-    } else if (dtype == HighFive::AtomicType<int64_t>()) {
-        return "int64_t";
-    } else if (dtype == HighFive::AtomicType<uint64_t>()) {
-        return "uint64_t";
-    } else if (dtype == HighFive::AtomicType<float>()) {
-        return "float";
-    } else if (dtype == HighFive::AtomicType<double>()) {
-        return "double";
-    } else if (dtype == HighFive::AtomicType<std::string>()) {
-        return "string";
-    } else {
+const std::string& _getDataType(const DatasetInfo& info, const std::string& name) {
+    if (info.dtype.empty()) {
         throw SonataError(fmt::format("Unexpected datatype for dataset '{}'", name));
     }
+    return info.dtype;
+}
+
+std::vector<std::string> _resolveEnumeration(const std::vector<size_t>& indices,
+                                             const std::vector<std::string>& values) {
+    std::vector<std::string> resolved;
+    resolved.reserve(indices.size());
+
+    const auto max = values.size();
+    for (const auto& i : indices) {
+        if (i >= max) {
+            throw SonataError(fmt::format("Invalid enumeration value: {}", i));
+        }
+        resolved.emplace_back(values[i]);
+    }
+
+    return resolved;
+}
+
+/// Copy the values of `selection` from `column` to `out`, unless the selection
+/// is out of bounds.
+template <typename T>
+bool _copyFromColumn(const std::vector<T>& column, const Selection& selection, T* out) {
+    const auto& ranges = selection.ranges();
+    for (const auto& range : ranges) {
+        if (std::get<1>(range) > column.size()) {
+            return false;
+        }
+    }
+
+    for (const auto& range : ranges) {
+        out = std::copy(column.begin() + static_cast<std::ptrdiff_t>(std::get<0>(range)),
+                        column.begin() + static_cast<std::ptrdiff_t>(std::get<1>(range)),
+                        out);
+    }
+    return true;
+}
+
+/// All values of `info` from the column cache of `hdf5_reader`, which are
+/// read and cached if needed; `nullptr` without a cache, or if the column
+/// can't fit in it. `lock` is only taken on a miss.
+///
+/// The size of strings is only known once they are read. If they turn out
+/// not to fit, the column just read is returned, and `nullptr` from then on,
+/// so that later reads only read their selection.
+template <typename T>
+std::shared_ptr<const std::vector<T>> _cachedColumn(const DatasetInfo& info,
+                                                    const Hdf5Reader& hdf5_reader,
+                                                    const detail::Hdf5Lock& lock) {
+    const auto& cache = hdf5_reader.options().column_cache;
+    if (cache == nullptr) {
+        return nullptr;
+    }
+
+    const Hdf5ColumnCache::Key key{info.file, info.path, typeid(T).name()};
+    if (auto cached = cache->find(key)) {
+        return std::static_pointer_cast<const std::vector<T>>(cached);
+    }
+
+    const auto n_values = info.element_count;
+    if (n_values * sizeof(T) > cache->maxBytes() || cache->isTooLarge(key)) {
+        return nullptr;
+    }
+
+    auto column = std::make_shared<std::vector<T>>();
+    if (n_values > 0) {
+        *column = _readSelection<T>(info, Selection({{0, n_values}}), hdf5_reader, lock);
+    }
+    cache->insert(key, column, detail::blockBytes(*column));
+    return column;
+}
+
+/// Read `selection` of `info`, which is planned as `plan`, from the column
+/// cache if there is one.
+template <typename T, typename Plan>
+std::vector<T> _readAttribute(const DatasetInfo& info,
+                              const Selection& selection,
+                              const Plan& plan,
+                              const Hdf5Reader& hdf5_reader,
+                              const detail::Hdf5Lock& lock) {
+    if (const auto column = _cachedColumn<T>(info, hdf5_reader, lock)) {
+        std::vector<T> values(selection.flatSize());
+        if (_copyFromColumn(*column, selection, values.data())) {
+            return values;
+        }
+    }
+    return _readSelection<T>(info, plan, hdf5_reader, lock);
+}
+
+template <typename T>
+std::vector<T> _readAttribute(const DatasetInfo& info,
+                              const Selection& selection,
+                              const Hdf5Reader& hdf5_reader,
+                              const detail::Hdf5Lock& lock) {
+    return _readAttribute<T>(info, selection, selection, hdf5_reader, lock);
 }
 
 }  // anonymous namespace
@@ -62,7 +138,8 @@ Population::Population(const std::string& h5FilePath,
                        const std::string& prefix,
                        const Hdf5Reader& hdf5_reader)
     : impl_([h5FilePath, csvFilePath, name, prefix, hdf5_reader] {
-        HDF5_LOCK_GUARD
+        const detail::Hdf5Lock lock(hdf5_reader.options().locking, h5FilePath);
+        HDF5_LOCK_GUARD(lock)
         return new Population::Impl(h5FilePath, csvFilePath, name, prefix, hdf5_reader);
     }()) {}
 
@@ -70,7 +147,13 @@ Population::Population(const std::string& h5FilePath,
 Population::Population(Population&&) noexcept = default;
 
 
-Population::~Population() noexcept = default;
+Population::~Population() noexcept {
+    if (impl_ != nullptr) {
+        const auto lock = impl_->hdf5_lock;
+        HDF5_LOCK_GUARD(lock)
+        impl_.reset();
+    }
+}
 
 
 std::string Population::name() const {
@@ -79,9 +162,7 @@ std::string Population::name() const {
 
 
 uint64_t Population::size() const {
-    HDF5_LOCK_GUARD
-    const auto dset = impl_->h5Root.getDataSet(fmt::format("{}_type_id", impl_->prefix));
-    return dset.getSpace().getDimensions()[0];
+    return impl_->getSize();
 }
 
 
@@ -101,19 +182,23 @@ const std::set<std::string>& Population::enumerationNames() const {
 
 
 std::vector<std::string> Population::enumerationValues(const std::string& name) const {
-    HDF5_LOCK_GUARD
-    const auto dset = impl_->getLibraryDataSet(name);
+    const auto& info = impl_->getLibraryInfo(name);
+    const auto selection = Selection({{0, info.dims[0]}});
 
-    // Note: can't use select all, because our locks aren't re-entrant
-    const auto selection = Selection({{0, dset.getSpace().getDimensions()[0]}});
-    return _readSelection<std::string>(dset, selection, impl_->hdf5_reader);
+    if (const auto column =
+            _cachedColumn<std::string>(info, impl_->hdf5_reader, impl_->hdf5_lock)) {
+        return *column;
+    }
+    return _readSelection<std::string>(info, selection, impl_->hdf5_reader, impl_->hdf5_lock);
 }
 
 
 template <typename T>
 std::vector<T> Population::getAttribute(const std::string& name, const Selection& selection) const {
-    HDF5_LOCK_GUARD
-    return _readSelection<T>(impl_->getAttributeDataSet(name), selection, impl_->hdf5_reader);
+    return _readAttribute<T>(impl_->getAttributeInfo(name),
+                             selection,
+                             impl_->hdf5_reader,
+                             impl_->hdf5_lock);
 }
 
 
@@ -121,27 +206,60 @@ template <>
 std::vector<std::string> Population::getAttribute<std::string>(const std::string& name,
                                                                const Selection& selection) const {
     if (impl_->attributeEnumNames.count(name) == 0) {
-        HDF5_LOCK_GUARD
-        return _readSelection<std::string>(impl_->getAttributeDataSet(name),
+        return _readAttribute<std::string>(impl_->getAttributeInfo(name),
                                            selection,
-                                           impl_->hdf5_reader);
+                                           impl_->hdf5_reader,
+                                           impl_->hdf5_lock);
     }
 
-    const auto indices = getAttribute<size_t>(name, selection);
-    const auto values = enumerationValues(name);
+    return _resolveEnumeration(getAttribute<size_t>(name, selection), enumerationValues(name));
+}
 
-    std::vector<std::string> resolved;
-    resolved.reserve(indices.size());
 
-    const auto max = values.size();
-    for (const auto& i : indices) {
-        if (i >= max) {
-            throw SonataError(fmt::format("Invalid enumeration value: {}", i));
-        }
-        resolved.emplace_back(values[i]);
+template <typename T>
+std::vector<std::vector<T>> Population::getAttributes(const std::vector<std::string>& names,
+                                                      const Selection& selection) const {
+    const SelectionPlan plan(selection);
+
+    std::vector<std::vector<T>> columns;
+    columns.reserve(names.size());
+
+    for (const auto& name : names) {
+        columns.push_back(_readAttribute<T>(impl_->getAttributeInfo(name),
+                                            selection,
+                                            plan,
+                                            impl_->hdf5_reader,
+                                            impl_->hdf5_lock));
     }
+    return columns;
+}
 
-    return resolved;
+
+template <>
+std::vector<std::vector<std::string>> Population::getAttributes<std::string>(
+    const std::vector<std::string>& names, const Selection& selection) const {
+    const SelectionPlan plan(selection);
+
+    std::vector<std::vector<std::string>> columns;
+    columns.reserve(names.size());
+    for (const auto& name : names) {
+        if (impl_->attributeEnumNames.count(name) == 0) {
+            columns.push_back(_readAttribute<std::string>(impl_->getAttributeInfo(name),
+                                                          selection,
+                                                          plan,
+                                                          impl_->hdf5_reader,
+                                                          impl_->hdf5_lock));
+            continue;
+        }
+
+        const auto indices = _readAttribute<size_t>(impl_->getAttributeInfo(name),
+                                                    selection,
+                                                    plan,
+                                                    impl_->hdf5_reader,
+                                                    impl_->hdf5_lock);
+        columns.push_back(_resolveEnumeration(indices, enumerationValues(name)));
+    }
+    return columns;
 }
 
 
@@ -154,6 +272,61 @@ std::vector<T> Population::getAttribute(const std::string& name,
 }
 
 
+template <typename T>
+void Population::getAttributeInto(const std::string& name,
+                                  const Selection& selection,
+                                  T* out) const {
+    const auto& info = impl_->getAttributeInfo(name);
+    if (info.element_count == 0) {
+        return;
+    }
+
+    if (const auto column = _cachedColumn<T>(info, impl_->hdf5_reader, impl_->hdf5_lock)) {
+        if (_copyFromColumn(*column, selection, out)) {
+            return;
+        }
+    }
+    _readSelectionInto<T>(info, selection, impl_->hdf5_reader, impl_->hdf5_lock, out);
+}
+
+
+template <typename T>
+std::shared_ptr<const T> Population::getAttributeView(const std::string& name,
+                                                      const Selection::Range& range) const {
+    const auto& info = impl_->getAttributeInfo(name);
+    const auto begin = std::get<0>(range);
+    const auto end = std::get<1>(range);
+    if (begin > end || end > info.element_count) {
+        throw SonataError(fmt::format("Range [{}, {}) is out of bounds of attribute '{}'",
+                                      begin,
+                                      end,
+                                      name));
+    }
+    // Shares the mappings of the reader, so that each file is mapped once.
+    const auto* resources = detail::readerResources(impl_->hdf5_reader);
+    if (resources == nullptr || resources->mapped_files == nullptr ||
+        info.layout != H5D_CONTIGUOUS) {
+        return nullptr;
+    }
+
+    auto& files = *resources->mapped_files;
+    const auto values = [&info, &files, this] {
+        HDF5_LOCK_GUARD(impl_->hdf5_lock)
+        return detail::mapValues<T>(info.dataset,
+                                    [&files](const std::string& path) { return files.get(path); });
+    }();
+    if (values.data == nullptr) {
+        return nullptr;
+    }
+
+    const auto* first = values.data + begin * sizeof(T);
+    if (reinterpret_cast<uintptr_t>(first) % alignof(T) != 0) {
+        return nullptr;
+    }
+    return std::shared_ptr<const T>(values.file, reinterpret_cast<const T*>(first));
+}
+
+
 template <typename T>
 std::vector<T> Population::getEnumeration(const std::string& name,
                                           const Selection& selection) const {
@@ -164,8 +337,10 @@ std::vector<T> Population::getEnumeration(const std::string& name,
         throw SonataError(fmt::format("Enumeration attribute '{}' can only be integer", name));
     }
 
-    HDF5_LOCK_GUARD
-    return _readSelection<T>(impl_->getAttributeDataSet(name), selection, impl_->hdf5_reader);
+    return _readAttribute<T>(impl_->getAttributeInfo(name),
+                             selection,
+                             impl_->hdf5_reader,
+                             impl_->hdf5_lock);
 }
 
 
@@ -175,8 +350,7 @@ std::string Population::_attributeDataType(const std::string& name,
         return "string";
     }
 
-    HDF5_LOCK_GUARD
-    return _getDataType(impl_->getAttributeDataSet(name), name);
+    return _getDataType(impl_->getAttributeInfo(name), name);
 }
 
 
@@ -188,10 +362,10 @@ const std::set<std::string>& Population::dynamicsAttributeNames() const {
 template <typename T>
 std::vector<T> Population::getDynamicsAttribute(const std::string& name,
                                                 const Selection& selection) const {
-    HDF5_LOCK_GUARD
-    return _readSelection<T>(impl_->getDynamicsAttributeDataSet(name),
+    return _readSelection<T>(impl_->getDynamicsAttributeInfo(name),
                              selection,
-                             impl_->hdf5_reader);
+                             impl_->hdf5_reader,
+                             impl_->hdf5_lock);
 }
 
 
@@ -205,18 +379,23 @@ std::vector<T> Population::getDynamicsAttribute(const std::string& name,
 
 
 std::string Population::_dynamicsAttributeDataType(const std::string& name) const {
-    HDF5_LOCK_GUARD
-    return _getDataType(impl_->getDynamicsAttributeDataSet(name), name);
+    return _getDataType(impl_->getDynamicsAttributeInfo(name), name);
 }
 
 template <>
 Selection Population::filterAttribute(const std::string& name,
                                       std::function<bool(const std::string)> pred) const {
-    auto dtype = impl_->getAttributeDataSet(name).getDataType();
-    if (dtype != HighFive::AtomicType<std::string>()) {
+    if (impl_->getAttributeInfo(name).dtype != "string") {
         throw SonataError("H5 dataset must be a string");
     }
 
+    const auto column = _cachedColumn<std::string>(impl_->getAttributeInfo(name),
+                                                   impl_->hdf5_reader,
+                                                   impl_->hdf5_lock);
+    if (column != nullptr) {
+        return _getMatchingSelection(*column, std::move(pred));
+    }
+
     const auto& values = getAttribute<std::string>(name, selectAll());
     return _getMatchingSelection(values, std::move(pred));
 }
@@ -224,11 +403,74 @@ Selection Population::filterAttribute(const std::string& name,
 template <typename T>
 Selection Population::filterAttribute(const std::string& name,
                                       std::function<bool(const T)> pred) const {
+    const auto column =
+        _cachedColumn<T>(impl_->getAttributeInfo(name), impl_->hdf5_reader, impl_->hdf5_lock);
+    if (column != nullptr) {
+        return _getMatchingSelection(*column, pred);
+    }
+
     const auto& values = getAttribute<T>(name, selectAll());
     return _getMatchingSelection(values, pred);
 }
 
 
+void Population::preload(const std::vector<std::string>& names) const {
+    if (impl_->hdf5_reader.options().column_cache == nullptr) {
+        throw SonataError("Preloading attributes requires Hdf5ReaderOptions::column_cache");
+    }
+
+    for (const auto& name : names) {
+        // Read as the type the bindings read it as, so that they hit the cache.
+        const auto dtype = _attributeDataType(name);
+        const auto& info = impl_->getAttributeInfo(name);
+        const auto& lock = impl_->hdf5_lock;
+        if (impl_->attributeEnumNames.count(name) > 0) {
+            _cachedColumn<size_t>(info, impl_->hdf5_reader, lock);
+            _cachedColumn<std::string>(impl_->getLibraryInfo(name), impl_->hdf5_reader, lock);
+        } else if (dtype == "int8_t") {
+            _cachedColumn<int8_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "uint8_t") {
+            _cachedColumn<uint8_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "int16_t") {
+            _cachedColumn<int16_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "uint16_t") {
+            _cachedColumn<uint16_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "int32_t") {
+            _cachedColumn<int32_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "uint32_t") {
+            _cachedColumn<uint32_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "int64_t") {
+            _cachedColumn<int64_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "uint64_t") {
+            _cachedColumn<uint64_t>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "float") {
+            _cachedColumn<float>(info, impl_->hdf5_reader, lock);
+        } else if (dtype == "double") {
+            _cachedColumn<double>(info, impl_->hdf5_reader, lock);
+        } else {
+            _cachedColumn<std::string>(info, impl_->hdf5_reader, lock);
+        }
+    }
+}
+
+
+void Population::evict() const {
+    const auto& cache = impl_->hdf5_reader.options().column_cache;
+    if (cache == nullptr) {
+        return;
+    }
+
+    for (const auto& name : impl_->attributeNames) {
+        const auto& info = impl_->getAttributeInfo(name);
+        cache->erase(info.file, info.path);
+    }
+    for (const auto& name : impl_->attributeEnumNames) {
+        const auto& info = impl_->getLibraryInfo(name);
+        cache->erase(info.file, info.path);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 
 #define INSTANTIATE_TEMPLATE_METHODS(T)                                                         \
@@ -237,6 +479,13 @@ Selection Population::filterAttribute(const std::string& name,
     template std::vector<T> Population::getAttribute<T>(const std::string&,                     \
                                                         const Selection&,                       \
                                                         const T&) const;                        \
+    template std::vector<std::vector<T>> Population::getAttributes<T>(                          \
+        const std::vector<std::string>&, const Selection&) const;                               \
+    template void Population::getAttributeInto<T>(const std::string&, const Selection&, T*)     \
+        const;                                                                                  \
+    template std::shared_ptr<const T> Population::getAttributeView<T>(const std::string&,       \
+                                                                      const Selection::Range&)  \
+        const;                                                                                  \
     template std::vector<T> Population::getEnumeration<T>(const std::string&, const Selection&) \
         const;                                                                                  \
     template std::vector<T> Population::getDynamicsAttribute<T>(const std::string&,             \
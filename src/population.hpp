@@ -13,9 +13,11 @@
 
 #include <bbp/sonata/population.h>
 
-#include <algorithm>  // stable_sort, transform
-#include <iterator>   // back_inserter
-#include <numeric>    // iota
+#include <algorithm>  // copy, max, min
+#include <cstddef>    // ptrdiff_t
+#include <map>
+#include <string>
+#include <utility>  // move
 #include <vector>
 
 #include <fmt/format.h>
@@ -28,6 +30,101 @@ namespace sonata {
 
 //--------------------------------------------------------------------------------------------------
 
+/// Name of the type of `dset`, as returned by `Population::_attributeDataType`,
+/// or an empty string if it isn't supported.
+inline std::string _dataTypeName(const HighFive::DataSet& dset) {
+    const auto dtype = dset.getDataType();
+    if (dtype == HighFive::AtomicType<int8_t>()) {
+        return "int8_t";
+    } else if (dtype == HighFive::AtomicType<uint8_t>()) {
+        return "uint8_t";
+    } else if (dtype == HighFive::AtomicType<int16_t>()) {
+        return "int16_t";
+    } else if (dtype == HighFive::AtomicType<uint16_t>()) {
+        return "uint16_t";
+    } else if (dtype == HighFive::AtomicType<int32_t>()) {
+        return "int32_t";
+    } else if (dtype == HighFive::AtomicType<uint32_t>()) {
+        return "uint32_t";
+    } else if (dtype == HighFive::AtomicType<int64_t>()) {
+        return "int64_t";
+    } else if (dtype == HighFive::AtomicType<uint64_t>()) {
+        return "uint64_t";
+    } else if (dtype == HighFive::AtomicType<float>()) {
+        return "float";
+    } else if (dtype == HighFive::AtomicType<double>()) {
+        return "double";
+    } else if (dtype == HighFive::AtomicType<std::string>()) {
+        return "string";
+    }
+    return {};
+}
+
+/// An open dataset of a population, with the metadata queried when the
+/// population is opened.
+///
+/// The metadata can be used without holding the HDF5 lock. The handle itself
+/// must only be used, or copied, while holding it.
+struct DatasetInfo {
+    explicit DatasetInfo(HighFive::DataSet dset)
+        : dataset(std::move(dset))
+        , file(dataset.getFile().getName())
+        , path(dataset.getPath())
+        , dtype(_dataTypeName(dataset))
+        , dims(dataset.getDimensions())
+        , element_count(dataset.getElementCount())
+        , layout(H5Pget_layout(dataset.getCreatePropertyList().getId())) {}
+
+    HighFive::DataSet dataset;
+    /// The name of the file, and the path of the dataset in there.
+    std::string file;
+    std::string path;
+    /// See `_dataTypeName`.
+    std::string dtype;
+    std::vector<size_t> dims;
+    size_t element_count;
+    H5D_layout_t layout;
+};
+
+/// Is the object `name` in `group` a dataset? `false` for dangling links.
+inline bool _isDataSet(const HighFive::Group& group, const std::string& name) {
+    try {
+        return group.getObjectType(name) == HighFive::ObjectType::Dataset;
+    } catch (const HighFive::Exception&) {
+        return false;
+    }
+}
+
+/// The datasets among `names` in `group`.
+///
+/// Other objects are skipped, so that they only fail once they are accessed,
+/// see `_findDataSet`.
+inline std::map<std::string, DatasetInfo> _openDataSets(const HighFive::Group& group,
+                                                        const std::set<std::string>& names) {
+    std::map<std::string, DatasetInfo> datasets;
+    for (const auto& name : names) {
+        if (_isDataSet(group, name)) {
+            datasets.emplace(name, DatasetInfo(group.getDataSet(name)));
+        }
+    }
+    return datasets;
+}
+
+/// The dataset `name` of the `kind` named `names`, as opened by `_openDataSets`.
+inline const DatasetInfo& _findDataSet(const std::map<std::string, DatasetInfo>& datasets,
+                                       const std::set<std::string>& names,
+                                       const std::string& name,
+                                       const char* kind) {
+    const auto it = datasets.find(name);
+    if (it != datasets.end()) {
+        return it->second;
+    }
+    if (names.count(name) > 0) {
+        throw SonataError(fmt::format("The {} '{}' is not a dataset", kind, name));
+    }
+    throw SonataError(fmt::format("No such {}: '{}'", kind, name));
+}
+
 namespace {
 
 constexpr const char* const H5_DYNAMICS_PARAMS = "dynamics_params";
@@ -58,51 +155,190 @@ std::set<std::string> _listExplicitEnumerations(const HighFive::Group h5Group,
     return names;
 }
 
-template <typename T>
-std::vector<T> _readSelection(const HighFive::DataSet& dset,
-                              const Selection& selection,
-                              const Hdf5Reader& hdf5_reader) {
-    if (dset.getElementCount() == 0) {
-        return {};
+/// How to read the values of a selection, shared by every dataset read for it.
+///
+/// A non-canonical selection is read as its canonical equivalent. Every range
+/// of the selection is a run of consecutive values in there, which is copied
+/// as a whole to where the selection wants it.
+struct SelectionPlan {
+    explicit SelectionPlan(const Selection& selection)
+        : canonical(bulk_read::detail::isCanonical(selection))
+        , ranges(canonical ? selection : Selection({}))
+        , flat_size(selection.flatSize()) {
+        if (canonical) {
+            return;
+        }
+
+        // Sweep the ranges by their start, merging the overlapping ones.
+        const auto& selected = selection.ranges();
+        Selection::Ranges canonical_ranges;
+        sources.resize(selected.size());
+        size_t offset = 0;  // of the last canonical range in the values read
+        for (const auto i : bulk_read::sortedOrder(selected)) {
+            const auto begin = std::get<0>(selected[i]);
+            const auto end = std::get<1>(selected[i]);
+            if (canonical_ranges.empty() || begin > std::get<1>(canonical_ranges.back())) {
+                if (!canonical_ranges.empty()) {
+                    offset += std::get<1>(canonical_ranges.back()) -
+                              std::get<0>(canonical_ranges.back());
+                }
+                canonical_ranges.push_back({begin, end});
+            } else {
+                std::get<1>(canonical_ranges.back()) =
+                    std::max(std::get<1>(canonical_ranges.back()), end);
+            }
+
+            const auto first = offset + (begin - std::get<0>(canonical_ranges.back()));
+            sources[i] = {first, first + (end - begin)};
+        }
+        ranges = Selection(std::move(canonical_ranges));
     }
 
-    if (bulk_read::detail::isCanonical(selection)) {
-        return hdf5_reader.readSelection<T>(dset, selection);
+    size_t flatSize() const {
+        return flat_size;
     }
 
-    // The fully general case:
-    //
-    // 1. Create a canonical selection and read into `linear_result`.
-    // 2. Copy values from the canonical `linear_results` to their final
-    //    destination.
-    auto canonicalRanges = bulk_read::sortAndMerge(selection, 0);
-    auto linear_result = hdf5_reader.readSelection<T>(dset, canonicalRanges);
+    /// True if the selection is canonical, and hence read as is.
+    bool canonical;
+    /// The canonical selection that is read.
+    Selection ranges;
+    /// Unless `canonical`, the values read for `ranges` which make up each
+    /// range of the selection, in the order of the selection.
+    Selection::Ranges sources;
+    size_t flat_size;
+};
 
-    const auto ids = selection.flatten();
+// Gathering fewer values is not worth starting a thread.
+constexpr size_t gather_min_values_per_thread = size_t(1) << 18;
 
-    std::vector<std::size_t> ids_index(ids.size());
-    std::iota(ids_index.begin(), ids_index.end(), std::size_t(0));
-    std::stable_sort(ids_index.begin(), ids_index.end(), [&ids](size_t i0, size_t i1) {
-        return ids[i0] < ids[i1];
-    });
+/// Copy the `sources` of `values`, one after the other, to `out`, using up to
+/// `n_threads` threads.
+template <typename T>
+void _gatherInto(const std::vector<T>& values,
+                 const Selection::Ranges& sources,
+                 size_t n_values,
+                 size_t n_threads,
+                 T* out) {
+    n_threads = std::min(n_threads, n_values / gather_min_values_per_thread);
+    if (n_threads <= 1) {
+        for (const auto& source : sources) {
+            out = std::copy(values.begin() + static_cast<std::ptrdiff_t>(std::get<0>(source)),
+                            values.begin() + static_cast<std::ptrdiff_t>(std::get<1>(source)),
+                            out);
+        }
+        return;
+    }
 
-    std::vector<T> result(ids.size());
-    size_t linear_index = 0;
-    result[ids_index[0]] = linear_result[0];
-    for (size_t i = 1; i < ids.size(); ++i) {
-        if (ids[ids_index[i - 1]] != ids[ids_index[i]]) {
-            linear_index += 1;
+    // Every thread copies an equal share of the sources; its output starts
+    // after the values of all earlier sources.
+    std::vector<size_t> first_source(n_threads + 1);
+    std::vector<size_t> first_out(n_threads + 1);
+    for (size_t part = 1, i = 0, n = 0; part <= n_threads; ++part) {
+        first_source[part] = sources.size() * part / n_threads;
+        for (; i < first_source[part]; ++i) {
+            n += std::get<1>(sources[i]) - std::get<0>(sources[i]);
         }
+        first_out[part] = n;
+    }
+
+    bulk_read::parallelFor(
+        n_threads,
+        [&](size_t, size_t part) {
+            T* part_out = out + first_out[part];
+            for (size_t i = first_source[part]; i < first_source[part + 1]; ++i) {
+                const auto& source = sources[i];
+                part_out = std::copy(values.begin() +
+                                         static_cast<std::ptrdiff_t>(std::get<0>(source)),
+                                     values.begin() +
+                                         static_cast<std::ptrdiff_t>(std::get<1>(source)),
+                                     part_out);
+            }
+        },
+        n_threads);
+}
 
-        result[ids_index[i]] = linear_result[linear_index];
+/// Read the values of `plan` from `info` into `out`, holding `lock` only
+/// while reading from the file, see `detail::guardPlugin`.
+template <typename T>
+void _readSelectionInto(const DatasetInfo& info,
+                        const SelectionPlan& plan,
+                        const Hdf5Reader& hdf5_reader,
+                        const detail::Hdf5Lock& lock,
+                        T* out) {
+    if (plan.canonical) {
+        const auto plugin_lock = detail::guardPlugin(hdf5_reader, lock);
+        hdf5_reader.readSelectionInto<T>(info.dataset, plan.ranges, out);
+        return;
     }
 
+    if (const auto& statistics = hdf5_reader.options().statistics) {
+        statistics->recordCanonicalization(info.path);
+    }
+    std::vector<T> linear_result;
+    {
+        const auto plugin_lock = detail::guardPlugin(hdf5_reader, lock);
+        linear_result = hdf5_reader.readSelection<T>(info.dataset, plan.ranges);
+    }
+    _gatherInto(linear_result,
+                plan.sources,
+                plan.flatSize(),
+                hdf5_reader.options().n_reader_threads,
+                out);
+}
+
+template <typename T>
+void _readSelectionInto(const DatasetInfo& info,
+                        const Selection& selection,
+                        const Hdf5Reader& hdf5_reader,
+                        const detail::Hdf5Lock& lock,
+                        T* out) {
+    _readSelectionInto(info, SelectionPlan(selection), hdf5_reader, lock, out);
+}
+
+template <typename T>
+std::vector<T> _readSelection(const DatasetInfo& info,
+                              const SelectionPlan& plan,
+                              const Hdf5Reader& hdf5_reader,
+                              const detail::Hdf5Lock& lock) {
+    if (info.element_count == 0) {
+        return {};
+    }
+
+    std::vector<T> result(plan.flatSize());
+    _readSelectionInto(info, plan, hdf5_reader, lock, result.data());
     return result;
 }
 
+template <typename T>
+std::vector<T> _readSelection(const DatasetInfo& info,
+                              const Selection& selection,
+                              const Hdf5Reader& hdf5_reader,
+                              const detail::Hdf5Lock& lock) {
+    return _readSelection<T>(info, SelectionPlan(selection), hdf5_reader, lock);
+}
+
 }  // unnamed namespace
 
 
+/// The names of the datasets in `group`.
+inline std::set<std::string> _listDataSets(const HighFive::Group& group) {
+    std::set<std::string> names;
+    for (const auto& name : group.listObjectNames()) {
+        if (_isDataSet(group, name)) {
+            names.insert(name);
+        }
+    }
+    return names;
+}
+
+/// The group of the attributes of the population `root`.
+inline HighFive::Group _attributeGroup(const HighFive::Group& root) {
+    if (root.exist("1")) {
+        throw SonataError("Only single-group populations are supported at the moment");
+    }
+    return root.getGroup("0");
+}
+
 inline HighFive::File open_hdf5_file(const std::string& filename, const Hdf5Reader& hdf5_reader) {
     return hdf5_reader.openFile(filename);
 }
@@ -117,51 +353,77 @@ struct Population::Impl {
         , prefix(_prefix)
         , h5File(open_hdf5_file(h5FilePath, hdf5_reader))
         , h5Root(h5File.getGroup(fmt::format("/{}s", prefix)).getGroup(name))
-        , attributeNames(_listChildren(h5Root.getGroup("0"), {H5_DYNAMICS_PARAMS, H5_LIBRARY}))
+        , h5Group(_attributeGroup(h5Root))
+        , attributeNames(_listChildren(h5Group, {H5_DYNAMICS_PARAMS, H5_LIBRARY}))
         , attributeEnumNames(
-              h5Root.getGroup("0").exist(H5_LIBRARY)
-                  ? _listExplicitEnumerations(h5Root.getGroup("0").getGroup(H5_LIBRARY),
-                                              attributeNames)
-                  : std::set<std::string>{})
-        , dynamicsAttributeNames(
-              h5Root.getGroup("0").exist(H5_DYNAMICS_PARAMS)
-                  ? _listChildren(h5Root.getGroup("0").getGroup(H5_DYNAMICS_PARAMS))
+              h5Group.exist(H5_LIBRARY)
+                  ? _listExplicitEnumerations(h5Group.getGroup(H5_LIBRARY), attributeNames)
                   : std::set<std::string>{})
-        , hdf5_reader(hdf5_reader) {
-        if (h5Root.exist("1")) {
-            throw SonataError("Only single-group populations are supported at the moment");
+        , dynamicsAttributeNames(h5Group.exist(H5_DYNAMICS_PARAMS)
+                                     ? _listChildren(h5Group.getGroup(H5_DYNAMICS_PARAMS))
+                                     : std::set<std::string>{})
+        , rootDatasets(_openDataSets(h5Root, _listDataSets(h5Root)))
+        , attributes(_openDataSets(h5Group, attributeNames))
+        , libraries(attributeEnumNames.empty()
+                        ? std::map<std::string, DatasetInfo>{}
+                        : _openDataSets(h5Group.getGroup(H5_LIBRARY), attributeEnumNames))
+        , dynamicsAttributes(
+              dynamicsAttributeNames.empty()
+                  ? std::map<std::string, DatasetInfo>{}
+                  : _openDataSets(h5Group.getGroup(H5_DYNAMICS_PARAMS), dynamicsAttributeNames))
+        , hdf5_reader(hdf5_reader)
+        , hdf5_lock(hdf5_reader.options().locking, h5FilePath) {}
+
+    const DatasetInfo& getRootInfo(const std::string& name) const {
+        const auto it = rootDatasets.find(name);
+        if (it == rootDatasets.end()) {
+            throw SonataError(fmt::format("No such dataset: '{}'", name));
         }
+        return it->second;
     }
 
-    HighFive::DataSet getAttributeDataSet(const std::string& name) const {
-        if (!attributeNames.count(name)) {
-            throw SonataError(fmt::format("No such attribute: '{}'", name));
-        }
-        return h5Root.getGroup("0").getDataSet(name);
+    const DatasetInfo& getAttributeInfo(const std::string& name) const {
+        return _findDataSet(attributes, attributeNames, name, "attribute");
     }
 
-    HighFive::DataSet getLibraryDataSet(const std::string& name) const {
-        if (!attributeEnumNames.count(name)) {
-            throw SonataError(fmt::format("No such enumeration attribute: '{}'", name));
-        }
-        return h5Root.getGroup("0").getGroup(H5_LIBRARY).getDataSet(name);
+    const DatasetInfo& getLibraryInfo(const std::string& name) const {
+        return _findDataSet(libraries, attributeEnumNames, name, "enumeration attribute");
     }
 
-    HighFive::DataSet getDynamicsAttributeDataSet(const std::string& name) const {
-        if (!dynamicsAttributeNames.count(name)) {
-            throw SonataError(fmt::format("No such dynamics attribute: '{}'", name));
-        }
-        return h5Root.getGroup("0").getGroup(H5_DYNAMICS_PARAMS).getDataSet(name);
+    const DatasetInfo& getDynamicsAttributeInfo(const std::string& name) const {
+        return _findDataSet(dynamicsAttributes,
+                            dynamicsAttributeNames,
+                            name,
+                            "dynamics attribute");
+    }
+
+    /// Number of elements; only fails, when called, if the `{prefix}_type_id`
+    /// dataset is missing.
+    uint64_t getSize() const {
+        return getRootInfo(typeIdName).dims[0];
     }
 
     const std::string name;
     const std::string prefix;
     const HighFive::File h5File;
     const HighFive::Group h5Root;
+    const HighFive::Group h5Group;
     const std::set<std::string> attributeNames;
     const std::set<std::string> attributeEnumNames;
     const std::set<std::string> dynamicsAttributeNames;
+    // Snapshot of the datasets taken when the population is opened, so that
+    // they aren't opened again for every read, and their metadata can be
+    // queried without the HDF5 lock. Objects which aren't datasets are left
+    // out, and fail when they are accessed.
+    const std::map<std::string, DatasetInfo> rootDatasets;
+    const std::string typeIdName = fmt::format("{}_type_id", prefix);
+    const std::map<std::string, DatasetInfo> attributes;
+    const std::map<std::string, DatasetInfo> libraries;
+    const std::map<std::string, DatasetInfo> dynamicsAttributes;
     const Hdf5Reader hdf5_reader;
+    // Held around all HDF5 calls for the population, including the closing
+    // of its handles.
+    const detail::Hdf5Lock hdf5_lock;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -181,7 +443,8 @@ struct PopulationStorage<Population>::Impl {
         , csvFilePath(_csvFilePath)
         , h5File(h5FilePath)
         , h5Root(h5File.getGroup(fmt::format("/{}s", Population::ELEMENT)))
-        , hdf5_reader(hdf5_reader) {
+        , hdf5_reader(hdf5_reader)
+        , hdf5_lock(hdf5_reader.options().locking, h5FilePath) {
         if (!csvFilePath.empty()) {
             throw SonataError("CSV not supported at the moment");
         }
@@ -192,6 +455,7 @@ struct PopulationStorage<Population>::Impl {
     const HighFive::File h5File;
     const HighFive::Group h5Root;
     const Hdf5Reader hdf5_reader;
+    const detail::Hdf5Lock hdf5_lock;
 };
 
 template <typename Population>
@@ -213,7 +477,8 @@ PopulationStorage<Population>::PopulationStorage(const std::string& h5FilePath,
                                                  const std::string& csvFilePath,
                                                  const Hdf5Reader& hdf5_reader)
     : impl_([h5FilePath, csvFilePath, hdf5_reader] {
-        HDF5_LOCK_GUARD
+        const detail::Hdf5Lock lock(hdf5_reader.options().locking, h5FilePath);
+        HDF5_LOCK_GUARD(lock)
         return new PopulationStorage::Impl(h5FilePath, csvFilePath, hdf5_reader);
     }()) {}
 
@@ -224,12 +489,18 @@ PopulationStorage<Population>::PopulationStorage(PopulationStorage<Population>&&
 
 
 template <typename Population>
-PopulationStorage<Population>::~PopulationStorage() noexcept = default;
+PopulationStorage<Population>::~PopulationStorage() noexcept {
+    if (impl_ != nullptr) {
+        const auto lock = impl_->hdf5_lock;
+        HDF5_LOCK_GUARD(lock)
+        impl_.reset();
+    }
+}
 
 
 template <typename Population>
 std::set<std::string> PopulationStorage<Population>::populationNames() const {
-    HDF5_LOCK_GUARD
+    HDF5_LOCK_GUARD(impl_->hdf5_lock)
     return _listChildren(impl_->h5Root);
 }
 
@@ -238,7 +509,7 @@ template <typename Population>
 std::shared_ptr<Population> PopulationStorage<Population>::openPopulation(
     const std::string& name) const {
     {
-        HDF5_LOCK_GUARD
+        HDF5_LOCK_GUARD(impl_->hdf5_lock)
         if (!impl_->h5Root.exist(name)) {
             throw SonataError(fmt::format("No such population: '{}'", name));
         }
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdint>
+#include <exception>
 #include <fmt/format.h>
+#include <mutex>
+#include <numeric>
+#include <thread>
 
 #include <bbp/sonata/population.h>
 
-#define SONATA_PAGESIZE (4 * 1 << 20)
-
 namespace bbp {
 namespace sonata {
 namespace bulk_read {
@@ -27,8 +30,8 @@ bool isCanonical(const std::vector<Range>& ranges) {
     return true;
 }
 
-inline bool isCanonical(const Selection selection) {
-    return isCanonical(selection.ranges());
+inline bool isCanonical(const Selection& selection) {
+    return selection.isCanonical();
 }
 
 /** Number of elements in the selection.
@@ -110,6 +113,96 @@ inline Selection sortAndMerge(const Selection& selection, size_t min_gap_size =
     return Selection(sortAndMerge(selection.ranges(), min_gap_size));
 }
 
+namespace detail {
+// Below this many ranges `std::stable_sort` beats the radix sort.
+constexpr size_t radix_sort_min_size = 1024;
+constexpr size_t radix_sort_digit_bits = 16;
+}  // namespace detail
+
+/** Indices of `ranges`, in the order of the start of the ranges.
+ *
+ *  The order is stable. Many ranges, e.g. of a selection built from an
+ *  unsorted list of IDs, are sorted with an LSD radix sort on their starts,
+ *  which is linear in the number of ranges and skips the digits above the
+ *  largest start.
+ */
+template <class Range>
+std::vector<size_t> sortedOrder(const std::vector<Range>& ranges) {
+    std::vector<size_t> order(ranges.size());
+    if (ranges.size() < detail::radix_sort_min_size) {
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&ranges](size_t i, size_t j) {
+            return std::get<0>(ranges[i]) < std::get<0>(ranges[j]);
+        });
+        return order;
+    }
+
+    // Keys and indices are kept together so that each pass scatters a single array.
+    struct Item {
+        uint64_t key;
+        size_t index;
+    };
+    std::vector<Item> items(ranges.size());
+    uint64_t max_key = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        items[i] = {static_cast<uint64_t>(std::get<0>(ranges[i])), i};
+        max_key = std::max(max_key, items[i].key);
+    }
+
+    constexpr size_t n_buckets = size_t(1) << detail::radix_sort_digit_bits;
+    std::vector<size_t> counts(n_buckets);
+    std::vector<Item> sorted(items.size());
+    for (size_t shift = 0; shift < 64 && (max_key >> shift) > 0;
+         shift += detail::radix_sort_digit_bits) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (const auto& item : items) {
+            ++counts[(item.key >> shift) & (n_buckets - 1)];
+        }
+
+        size_t first = 0;
+        for (auto& count : counts) {
+            const auto n = count;
+            count = first;
+            first += n;
+        }
+
+        for (const auto& item : items) {
+            sorted[counts[(item.key >> shift) & (n_buckets - 1)]++] = item;
+        }
+        items.swap(sorted);
+    }
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        order[i] = items[i].index;
+    }
+    return order;
+}
+
+/** Merge consecutive blocks that overlap the same chunk.
+ *
+ * HDF5 reads chunked datasets one chunk at a time; for compressed datasets
+ * the whole chunk is also decompressed. If two blocks share a chunk, it's
+ * read twice. After merging, every chunk is part of at most one block.
+ *
+ * The `blocks` must be canonical, `chunk_size` is the number of elements per
+ * chunk.
+ */
+template <class Range>
+std::vector<Range> mergeSharedChunks(const std::vector<Range>& blocks, size_t chunk_size) {
+    std::vector<Range> ret;
+    ret.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        if (!ret.empty() &&
+            (std::get<1>(ret.back()) - 1) / chunk_size == std::get<0>(block) / chunk_size) {
+            std::get<1>(ret.back()) = std::get<1>(block);
+        } else {
+            ret.push_back(block);
+        }
+    }
+
+    return ret;
+}
+
 
 /** Extract a slice of values from a block.
  *
@@ -152,24 +245,36 @@ void extractBlock(T* const out,
  *
  *  the function object `readBlock` must fill `buffer` (an `std::vector<T>`)
  *  with the values for `range`. The algorithm will then extract the required
- *  values (controlled by `subranges`).
+ *  values (controlled by `subranges`) and write them to consecutive locations
+ *  starting at `out`, which must have room for `flatSize(subranges)` values.
+ *
+ *  If a block is exactly one subrange, there's nothing to extract and the
+ *  block is instead read directly into its destination by calling
+ *
+ *      readBlockInto(out, range);
  *
  *  Note that both `ranges` and `subranges` must be canonical (sorted and
  *  non-overlapping). Additionally, any range in `subranges` must be fully
  *  contained in exactly one range in `ranges`.
  */
-template <class T, class F, class Range>
-std::vector<T> bulkRead(F readBlock,
-                        const std::vector<Range>& ranges,
-                        const std::vector<Range>& subranges) {
-    std::vector<T> values(detail::flatSize(subranges));
-    T* values_ptr = values.data();
-
+template <class T, class F, class G, class Range>
+void bulkReadInto(F readBlock,
+                  G readBlockInto,
+                  const std::vector<Range>& ranges,
+                  const std::vector<Range>& subranges,
+                  T* out) {
     std::vector<T> buffer;
 
     size_t k_sub = 0;
     size_t n_sub = subranges.size();
     for (const auto& range : ranges) {
+        if (k_sub < n_sub && subranges[k_sub] == range) {
+            readBlockInto(out, range);
+            out += std::get<1>(range) - std::get<0>(range);
+            ++k_sub;
+            continue;
+        }
+
         readBlock(buffer, range);
 
         for (; k_sub < n_sub; ++k_sub) {
@@ -178,11 +283,471 @@ std::vector<T> bulkRead(F readBlock,
                 break;
             }
 
-            extractBlock(values_ptr, buffer.data(), range, subrange);
-            values_ptr += std::get<1>(subrange) - std::get<0>(subrange);
+            extractBlock(out, buffer.data(), range, subrange);
+            out += std::get<1>(subrange) - std::get<0>(subrange);
+        }
+    }
+}
+
+/** Read items in background threads and consume them in order.
+ *
+ *  Items `[0, n_items)` are read by `n_threads` worker threads, calling
+ *
+ *      read(thread_id, i);
+ *
+ *  where `thread_id` is in `[0, n_threads)`. Meanwhile, the calling thread
+ *  calls `consume(i)` for every item, in order, as soon as it has been read.
+ *  Item `i` is only read once item `i - queue_size` has been consumed, hence
+ *  `i % queue_size` can be used to recycle buffers.
+ *
+ *  If `serialize_reads` is set, no two reads run at the same time, e.g.
+ *  because the HDF5 library isn't threadsafe. Reading still overlaps with
+ *  consuming.
+ *
+ *  The first exception thrown by `read` or `consume` is rethrown in the
+ *  calling thread, after all threads have been joined.
+ */
+template <class F, class G>
+void pipeline(size_t n_items,
+              F read,
+              G consume,
+              size_t n_threads,
+              size_t queue_size,
+              bool serialize_reads) {
+    n_threads = std::max<size_t>(1, std::min(n_threads, n_items));
+    queue_size = std::max<size_t>(1, queue_size);
+
+    std::vector<char> ready(n_items, 0);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next_item = 0;
+    size_t consumed = 0;
+    bool abort = false;
+    std::exception_ptr error;
+
+    std::mutex read_mutex;
+
+    auto fail = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = e;
+        }
+        abort = true;
+        cv.notify_all();
+    };
+
+    auto worker = [&](size_t thread_id) {
+        while (true) {
+            size_t i = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] {
+                    return abort || next_item >= n_items || next_item < consumed + queue_size;
+                });
+                if (abort || next_item >= n_items) {
+                    return;
+                }
+                i = next_item++;
+            }
+
+            try {
+                std::unique_lock<std::mutex> read_lock(read_mutex, std::defer_lock);
+                if (serialize_reads) {
+                    read_lock.lock();
+                }
+                read(thread_id, i);
+            } catch (...) {
+                fail(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[i] = 1;
+            }
+            cv.notify_all();
         }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads);
+    for (size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back(worker, t);
     }
 
+    try {
+        for (size_t i = 0; i < n_items; ++i) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return abort || ready[i] != 0; });
+                if (abort) {
+                    break;
+                }
+            }
+
+            consume(i);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++consumed;
+            }
+            cv.notify_all();
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/** Call `f(thread_id, i)` for every item `i` in `[0, n_items)`.
+ *
+ *  The items are processed by `n_threads` threads, including the calling
+ *  thread, which has `thread_id == 0`. Items are handed out in order, but may
+ *  complete in any order.
+ *
+ *  The first exception thrown by `f` is rethrown in the calling thread,
+ *  after all threads have been joined; no further items are started once
+ *  an exception has been thrown.
+ */
+template <class F>
+void parallelFor(size_t n_items, F f, size_t n_threads) {
+    n_threads = std::max<size_t>(1, std::min(n_threads, n_items));
+
+    std::mutex mutex;
+    size_t next_item = 0;
+    std::exception_ptr error;
+
+    auto worker = [&](size_t thread_id) {
+        while (true) {
+            size_t i = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error || next_item >= n_items) {
+                    return;
+                }
+                i = next_item++;
+            }
+
+            try {
+                f(thread_id, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    for (size_t thread_id = 1; thread_id < n_threads; ++thread_id) {
+        threads.emplace_back(worker, thread_id);
+    }
+    worker(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/** Pipelined variant of `bulkReadInto`.
+ *
+ *  The blocks are read by `n_threads` threads, see `pipeline`, calling
+ *
+ *      readBlock(thread_id, buffer, range);
+ *      readBlockInto(thread_id, out, range);
+ *
+ *  while the calling thread extracts the values of blocks that have already
+ *  been read. At most `queue_size` blocks are read ahead of the block being
+ *  extracted, which bounds the memory used for buffers.
+ */
+template <class T, class F, class G, class Range>
+void pipelinedBulkReadInto(F readBlock,
+                           G readBlockInto,
+                           const std::vector<Range>& ranges,
+                           const std::vector<Range>& subranges,
+                           T* out,
+                           size_t n_threads,
+                           size_t queue_size,
+                           bool serialize_reads) {
+    const size_t n_blocks = ranges.size();
+    queue_size = std::max<size_t>(1, std::min(queue_size, n_blocks));
+
+    // The subranges of block `b` are `[first_sub[b], first_sub[b + 1])`, its
+    // values are written to `out + offsets[b]`.
+    std::vector<size_t> first_sub(n_blocks + 1, subranges.size());
+    std::vector<size_t> offsets(n_blocks + 1, 0);
+    {
+        size_t k_sub = 0;
+        size_t offset = 0;
+        for (size_t b = 0; b < n_blocks; ++b) {
+            first_sub[b] = k_sub;
+            offsets[b] = offset;
+            for (; k_sub < subranges.size(); ++k_sub) {
+                if (std::get<1>(subranges[k_sub]) > std::get<1>(ranges[b])) {
+                    break;
+                }
+                offset += std::get<1>(subranges[k_sub]) - std::get<0>(subranges[k_sub]);
+            }
+        }
+    }
+    const auto isDirect = [&](size_t b) {
+        return first_sub[b + 1] - first_sub[b] == 1 && subranges[first_sub[b]] == ranges[b];
+    };
+
+    std::vector<std::vector<T>> buffers(queue_size);
+
+    auto read = [&](size_t thread_id, size_t b) {
+        if (isDirect(b)) {
+            readBlockInto(thread_id, out + offsets[b], ranges[b]);
+        } else {
+            readBlock(thread_id, buffers[b % queue_size], ranges[b]);
+        }
+    };
+
+    auto extract = [&](size_t b) {
+        if (isDirect(b)) {
+            return;
+        }
+
+        const auto& buffer = buffers[b % queue_size];
+        T* block_out = out + offsets[b];
+        for (size_t k_sub = first_sub[b]; k_sub < first_sub[b + 1]; ++k_sub) {
+            const auto& subrange = subranges[k_sub];
+            extractBlock(block_out, buffer.data(), ranges[b], subrange);
+            block_out += std::get<1>(subrange) - std::get<0>(subrange);
+        }
+    };
+
+    pipeline(n_blocks, read, extract, n_threads, queue_size, serialize_reads);
+}
+
+/** Split `subranges` where they cross from one block into the next.
+ *
+ *  Every subrange must be covered by `blocks`, which must be canonical. The
+ *  returned subranges are each contained in exactly one block.
+ */
+template <class Range>
+std::vector<Range> splitSubranges(const std::vector<Range>& blocks,
+                                  const std::vector<Range>& subranges) {
+    std::vector<Range> split_subranges;
+    split_subranges.reserve(subranges.size());
+
+    size_t k_block = 0;
+    for (const auto& subrange : subranges) {
+        auto begin = std::get<0>(subrange);
+        const auto end = std::get<1>(subrange);
+        while (begin < end) {
+            while (std::get<1>(blocks[k_block]) <= begin) {
+                ++k_block;
+            }
+            const auto cut = std::min(end, std::get<1>(blocks[k_block]));
+            split_subranges.push_back({begin, cut});
+            begin = cut;
+        }
+    }
+
+    return split_subranges;
+}
+
+/** The aligned blocks of `block_size` elements touched by the canonical `ranges`.
+ *
+ *  The last block is cut at `size`, the number of elements of the array.
+ */
+template <class Range>
+std::vector<Range> alignedBlocks(const std::vector<Range>& ranges,
+                                 size_t block_size,
+                                 size_t size) {
+    std::vector<Range> blocks;
+    for (const auto& range : ranges) {
+        if (std::get<0>(range) == std::get<1>(range)) {
+            continue;
+        }
+
+        auto first = std::get<0>(range) / block_size;
+        const auto last = (std::get<1>(range) - 1) / block_size;
+        if (!blocks.empty() && std::get<0>(blocks.back()) == first * block_size) {
+            ++first;
+        }
+        for (auto k = first; k <= last; ++k) {
+            blocks.push_back({k * block_size, std::min<decltype(k)>((k + 1) * block_size, size)});
+        }
+    }
+
+    return blocks;
+}
+
+/** Split blocks longer than `max_block_size`.
+ *
+ *  Blocks are cut at multiples of `max_block_size`, and the subranges at the
+ *  same places, such that every subrange is still contained in exactly one
+ *  block. This lets a single large range be read in several pieces, e.g. to
+ *  overlap reading one piece with extracting the previous one.
+ */
+template <class Range>
+void splitLargeBlocks(std::vector<Range>& blocks,
+                      std::vector<Range>& subranges,
+                      size_t max_block_size) {
+    if (max_block_size == 0) {
+        return;
+    }
+
+    const auto needsSplit = [max_block_size](const Range& range) {
+        return std::get<1>(range) - std::get<0>(range) > max_block_size;
+    };
+    if (std::none_of(blocks.begin(), blocks.end(), needsSplit)) {
+        return;
+    }
+
+    std::vector<Range> split_blocks;
+    for (const auto& block : blocks) {
+        auto begin = std::get<0>(block);
+        const auto end = std::get<1>(block);
+        if (!needsSplit(block)) {
+            split_blocks.push_back(block);
+            continue;
+        }
+        while (begin < end) {
+            const auto next_cut = (begin / max_block_size + 1) * max_block_size;
+            const auto cut = std::min<decltype(begin)>(next_cut, end);
+            split_blocks.push_back({begin, cut});
+            begin = cut;
+        }
+    }
+
+    blocks = std::move(split_blocks);
+    subranges = splitSubranges(blocks, subranges);
+}
+
+/** Two-dimensional merge-read-extract.
+ *
+ *  Reads the Cartesian product of the rows `xranges` and the columns
+ *  `yranges` of a two-dimensional array in blocks, one for every pair of a
+ *  row block in `xblocks` and a column block in `yblocks`, by calling
+ *
+ *      readBlock(buffer, xblock, yblock);
+ *
+ *  which must fill `buffer` (an `std::vector<T>`) with the values of the
+ *  block in row-major order. The requested values are written to `out` in
+ *  row-major order, i.e. `out` is a matrix with `flatSize(xranges)` rows and
+ *  `flatSize(yranges)` columns.
+ *
+ *  If all columns are read as one block and a row block is exactly one of
+ *  `xranges`, the rows are instead read directly into their destination by
+ *  calling
+ *
+ *      readBlockInto(out, xblock, yblock);
+ *
+ *  The blocks and ranges of both axes must satisfy the requirements of
+ *  `bulkReadInto`.
+ */
+template <class T, class F, class G, class Range>
+void bulkReadInto2D(F readBlock,
+                    G readBlockInto,
+                    const std::vector<Range>& xblocks,
+                    const std::vector<Range>& xranges,
+                    const std::vector<Range>& yblocks,
+                    const std::vector<Range>& yranges,
+                    T* out) {
+    const size_t n_cols = detail::flatSize(yranges);
+    if (n_cols == 0) {
+        return;
+    }
+
+    // The column ranges of column block `b` are `[first_y[b], first_y[b + 1])`;
+    // column range `k` is written to column `y_offsets[k]` of `out`.
+    std::vector<size_t> first_y(yblocks.size() + 1, yranges.size());
+    std::vector<size_t> y_offsets(yranges.size());
+    {
+        size_t k = 0;
+        size_t offset = 0;
+        for (size_t b = 0; b < yblocks.size(); ++b) {
+            first_y[b] = k;
+            for (; k < yranges.size(); ++k) {
+                if (std::get<1>(yranges[k]) > std::get<1>(yblocks[b])) {
+                    break;
+                }
+                y_offsets[k] = offset;
+                offset += std::get<1>(yranges[k]) - std::get<0>(yranges[k]);
+            }
+        }
+    }
+    const bool full_rows = yblocks.size() == 1 && yranges.size() == 1 &&
+                           yblocks[0] == yranges[0];
+
+    std::vector<T> buffer;
+
+    size_t k_x = 0;
+    size_t n_x = xranges.size();
+    T* rows_out = out;
+    for (const auto& xblock : xblocks) {
+        if (full_rows && k_x < n_x && xranges[k_x] == xblock) {
+            readBlockInto(rows_out, xblock, yblocks[0]);
+            rows_out += (std::get<1>(xblock) - std::get<0>(xblock)) * n_cols;
+            ++k_x;
+            continue;
+        }
+
+        const size_t k_x_begin = k_x;
+        while (k_x < n_x && std::get<1>(xranges[k_x]) <= std::get<1>(xblock)) {
+            ++k_x;
+        }
+
+        for (size_t b = 0; b < yblocks.size(); ++b) {
+            const auto& yblock = yblocks[b];
+            const size_t width = std::get<1>(yblock) - std::get<0>(yblock);
+            readBlock(buffer, xblock, yblock);
+
+            T* row_out = rows_out;
+            for (size_t k = k_x_begin; k < k_x; ++k) {
+                for (auto i = std::get<0>(xranges[k]); i < std::get<1>(xranges[k]); ++i) {
+                    const T* row = buffer.data() + (i - std::get<0>(xblock)) * width;
+                    for (size_t k_y = first_y[b]; k_y < first_y[b + 1]; ++k_y) {
+                        extractBlock(row_out + y_offsets[k_y], row, yblock, yranges[k_y]);
+                    }
+                    row_out += n_cols;
+                }
+            }
+        }
+
+        for (size_t k = k_x_begin; k < k_x; ++k) {
+            rows_out += (std::get<1>(xranges[k]) - std::get<0>(xranges[k])) * n_cols;
+        }
+    }
+}
+
+/** Read larger block and extract required values in memory.
+ *
+ *  As `bulkReadInto`, but returns the values. Every block is read with
+ *  `readBlock`.
+ */
+template <class T, class F, class Range>
+std::vector<T> bulkRead(F readBlock,
+                        const std::vector<Range>& ranges,
+                        const std::vector<Range>& subranges) {
+    std::vector<T> values(detail::flatSize(subranges));
+
+    std::vector<T> buffer;
+    auto readBlockInto = [&readBlock, &buffer](T* out, const Range& range) {
+        readBlock(buffer, range);
+        std::move(buffer.begin(), buffer.end(), out);
+    };
+    bulkReadInto(readBlock, readBlockInto, ranges, subranges, values.data());
+
     return values;
 }
 
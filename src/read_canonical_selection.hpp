@@ -1,63 +1,1044 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
+#include <bbp/sonata/hdf5_reader.h>
 #include <highfive/H5File.hpp>
 
+#include "chunk_filters.hpp"
+#include "hdf5_mutex.hpp"
+#include "io_uring_reader.hpp"
+#include "mapped_file.hpp"
 #include "read_bulk.hpp"
 
 namespace bbp {
 namespace sonata {
 namespace detail {
 
+template <class Range>
+HighFive::HyperSlab _makeHyperslab(const std::vector<Range>& ranges) {
+    HighFive::HyperSlab slab;
+    for (const auto& range : ranges) {
+        size_t i_begin = std::get<0>(range);
+        size_t i_end = std::get<1>(range);
+        slab |= HighFive::RegularHyperSlab({i_begin}, {i_end - i_begin});
+    }
+
+    return slab;
+}
+
+/// Thresholds, in elements along one axis, for merging ranges of one dataset.
+struct MergeParameters {
+    size_t min_gap_size;
+    size_t max_aggregated_block_size;
+    /// Elements per chunk along the axis; `0` unless chunks are taken into account.
+    size_t chunk_size = 0;
+};
+
+inline size_t roundUpToMultiple(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/// Merge thresholds for `dset` along `axis`, where `element_size` is the number
+/// of bytes per element along that axis.
+inline MergeParameters mergeParameters(const HighFive::DataSet& dset,
+                                       size_t element_size,
+                                       size_t min_gap_bytes,
+                                       size_t max_aggregated_block_bytes,
+                                       bool chunk_aware,
+                                       size_t axis = 0) {
+    element_size = std::max<size_t>(1, element_size);
+    MergeParameters params{min_gap_bytes / element_size,
+                           max_aggregated_block_bytes / element_size};
+    if (!chunk_aware) {
+        return params;
+    }
+
+    const auto plist = dset.getCreatePropertyList();
+    if (H5Pget_layout(plist.getId()) != H5D_CHUNKED) {
+        return params;
+    }
+
+    std::vector<hsize_t> chunk_dims(dset.getSpace().getNumberDimensions());
+    if (chunk_dims.size() <= axis ||
+        H5Pget_chunk(plist.getId(), static_cast<int>(chunk_dims.size()), chunk_dims.data()) < 0) {
+        throw SonataError("Failed to query the chunk dimensions");
+    }
+
+    const auto chunk_size = static_cast<size_t>(chunk_dims[axis]);
+    params.chunk_size = chunk_size;
+    if (H5Pget_nfilters(plist.getId()) > 0) {
+        // Merging gaps shorter than a chunk never reads a chunk that isn't needed anyway,
+        // anything longer would decompress unneeded chunks.
+        params.min_gap_size = chunk_size;
+    } else {
+        params.min_gap_size = roundUpToMultiple(std::max(params.min_gap_size, chunk_size),
+                                                chunk_size);
+    }
+    params.max_aggregated_block_size =
+        roundUpToMultiple(std::max(params.max_aggregated_block_size, chunk_size), chunk_size);
+
+    return params;
+}
+
+/// The blocks in which to read the canonical `ranges`.
+template <class Range>
+std::vector<Range> mergedBlocks(const std::vector<Range>& ranges, const MergeParameters& params) {
+    auto blocks = bulk_read::sortAndMerge(ranges,
+                                          params.min_gap_size,
+                                          params.max_aggregated_block_size);
+    if (params.chunk_size > 0) {
+        blocks = bulk_read::mergeSharedChunks(blocks, params.chunk_size);
+    }
+    return blocks;
+}
+
+// Thresholds of `Hdf5ReaderOptions::ReadMode::automatic`, measured with HDF5
+// 1.10 reading doubles of a contiguous dataset from the page cache, see
+// `tests/benchmark_hdf5_reader.cpp`:
+//  - A hyperslab of up to 128 ranges is read 10-30% faster than with one call
+//    per range, at about 5us per range. Beyond that, HDF5 takes quadratic time
+//    to build the selection: 256 ranges are slower, 10000 ranges take 2.7s
+//    rather than 40ms.
+//  - Reading a merged block costs about 0.1ns per byte, hence merging only
+//    loses if it reads more than about 128 KiB of unneeded values per range.
+const size_t hyperslab_max_ranges = 128;
+const size_t hyperslab_min_discarded_bytes_per_range = size_t(128) << 10;
+
+/// Should the canonical `ranges` be read as one hyperslab rather than as `blocks`?
+///
+/// `element_size` is the number of bytes per element. Datasets read by whole
+/// chunks, i.e. with `params.chunk_size` set, are always read as `blocks`.
+template <class Range>
+bool useHyperslab(const std::vector<Range>& ranges,
+                  const std::vector<Range>& blocks,
+                  const MergeParameters& params,
+                  size_t element_size,
+                  Hdf5ReaderOptions::ReadMode mode) {
+    switch (mode) {
+    case Hdf5ReaderOptions::ReadMode::merge:
+        return false;
+    case Hdf5ReaderOptions::ReadMode::hyperslab:
+        return true;
+    case Hdf5ReaderOptions::ReadMode::automatic:
+        break;
+    }
+
+    if (params.chunk_size > 0 || ranges.size() <= 1 || ranges.size() > hyperslab_max_ranges) {
+        return false;
+    }
+
+    // Unless most blocks are a single range, merging saves more calls than
+    // a hyperslab saves per range.
+    if (4 * ranges.size() <= 5 * blocks.size()) {
+        return true;
+    }
+
+    const size_t discarded = bulk_read::detail::flatSize(blocks) -
+                             bulk_read::detail::flatSize(ranges);
+    return discarded * element_size >= hyperslab_min_discarded_bytes_per_range * ranges.size();
+}
+
+/// Read the selected part of a dataset into `out`, without a temporary buffer if possible.
 template <class T>
-std::vector<T> readCanonicalSelection(const HighFive::DataSet& dset, const Selection& selection) {
-    if (selection.empty()) {
+void readInto(const HighFive::Selection& selection, T* out, std::true_type /* is_arithmetic */) {
+    selection.read_raw(out);
+}
+
+template <class T>
+void readInto(const HighFive::Selection& selection, T* out, std::false_type /* is_arithmetic */) {
+    std::vector<T> buffer;
+    selection.read(buffer);
+    std::move(buffer.begin(), buffer.end(), out);
+}
+
+template <class T>
+void readInto(const HighFive::Selection& selection, T* out) {
+    readInto(selection, out, std::is_arithmetic<T>());
+}
+
+/// Records the reads of one dataset, if `Hdf5ReaderOptions::statistics` is set.
+class ReadRecorder
+{
+  public:
+    /// `lock` is held while querying the path of `dset`.
+    ReadRecorder(const HighFive::DataSet& dset,
+                 const Hdf5ReaderOptions& options,
+                 const Hdf5Lock& lock)
+        : statistics_(options.statistics.get()) {
+        if (statistics_ != nullptr) {
+            HDF5_LOCK_GUARD(lock)
+            dataset_ = dset.getPath();
+        }
+    }
+
+    void request(size_t n_elements) const {
+        if (statistics_ != nullptr) {
+            statistics_->recordRequest(dataset_, n_elements);
+        }
+    }
+
+    /// Call `read()`, which reads `n_elements` with one HDF5 call.
+    template <class F>
+    void read(size_t n_elements, F read) const {
+        if (statistics_ == nullptr) {
+            read();
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        read();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        statistics_->recordRead(dataset_, n_elements, elapsed.count());
+    }
+
+  private:
+    Hdf5ReaderStatistics* statistics_;
+    std::string dataset_;
+};
+
+/// Approximate number of bytes used by a block kept in an `Hdf5BlockCache`.
+template <class T>
+size_t blockBytes(const std::vector<T>& block) {
+    return block.size() * sizeof(T);
+}
+
+inline size_t blockBytes(const std::vector<std::string>& block) {
+    size_t bytes = block.size() * sizeof(std::string);
+    for (const auto& value : block) {
+        bytes += value.capacity();
+    }
+    return bytes;
+}
+
+/// Read `blocks` and extract `subranges` into `out`, with reader threads or
+/// prefetching if requested by `options`.
+template <class T, class F, class G, class Range>
+void readBlocksInto(F readBlock,
+                    G readBlockInto,
+                    const std::vector<Range>& blocks,
+                    const std::vector<Range>& subranges,
+                    const Hdf5ReaderOptions& options,
+                    T* out) {
+    const auto n_threads = std::max<size_t>(1, options.n_reader_threads);
+    if ((n_threads > 1 || options.prefetch_depth > 0) && blocks.size() > 1) {
+        const auto queue_size = options.prefetch_depth > 0 ? options.prefetch_depth
+                                                           : 2 * n_threads;
+
+        // Every read takes the HDF5 lock itself, which keeps the reader threads
+        // apart unless HDF5 is thread-safe, see `Hdf5Lock::forRead`.
+        bulk_read::pipelinedBulkReadInto(
+            [&](size_t, auto& buffer, const auto& range) { readBlock(buffer, range); },
+            [&](size_t, T* block_out, const auto& range) { readBlockInto(block_out, range); },
+            blocks,
+            subranges,
+            out,
+            n_threads,
+            queue_size,
+            /* serialize_reads */ false);
+        return;
+    }
+
+    bulk_read::bulkReadInto(readBlock, readBlockInto, blocks, subranges, out);
+}
+
+/// State of one reader, shared by all its reads.
+struct ReaderResources {
+    /// The files mapped by the reader; `nullptr` unless `memory_map` is set.
+    std::shared_ptr<MappedFiles> mapped_files;
+    /// `nullptr` unless `io_uring_queue_depth` is set, and io_uring is available.
+    std::shared_ptr<IoUringReader> io_uring;
+};
+
+/// Where the values of a dataset are stored on disk.
+struct ContiguousStorage {
+    std::string path;
+    /// Offset of the first value in `path`; `HADDR_UNDEF` if the values aren't
+    /// stored contiguously in `path`.
+    haddr_t offset = HADDR_UNDEF;
+};
+
+template <class T>
+ContiguousStorage contiguousStorage(const HighFive::DataSet&, std::false_type /* is_arithmetic */) {
+    return {};
+}
+
+template <class T>
+ContiguousStorage contiguousStorage(const HighFive::DataSet& dset,
+                                    std::true_type /* is_arithmetic */) {
+    const auto dcpl = dset.getCreatePropertyList();
+    if (H5Pget_layout(dcpl.getId()) != H5D_CONTIGUOUS ||
+        H5Pget_external_count(dcpl.getId()) != 0) {
+        return {};
+    }
+    if (!(dset.getDataType() == HighFive::AtomicType<T>())) {
+        return {};
+    }
+
+    const haddr_t offset = H5Dget_offset(dset.getId());
+    if (offset == HADDR_UNDEF) {
+        // Nothing was written to the dataset yet.
+        return {};
+    }
+
+    // Only with the default driver are addresses in the HDF5 file offsets in
+    // a single file on disk.
+    const auto file = dset.getFile();
+    const hid_t fapl = H5Fget_access_plist(file.getId());
+    if (fapl < 0) {
+        return {};
+    }
+    const hid_t driver = H5Pget_driver(fapl);
+    H5Pclose(fapl);
+    if (driver != H5FD_SEC2) {
+        return {};
+    }
+
+    return {file.getName(), offset};
+}
+
+/// The location of the values of `dset` in its file.
+///
+/// Only contiguous datasets stored in the HDF5 file itself, in the native
+/// representation of `T`, have one. Hence, the values can be read without
+/// HDF5, and without any conversion.
+template <class T>
+ContiguousStorage contiguousStorage(const HighFive::DataSet& dset) {
+    return contiguousStorage<T>(dset, std::is_arithmetic<T>());
+}
+
+/// The values of a dataset, read straight from a memory map of its file.
+struct MappedValues {
+    std::shared_ptr<const MappedFile> file;
+    /// The first value; `nullptr` if the dataset can't be mapped.
+    const char* data = nullptr;
+};
+
+/// Map the values of `dset` into memory, where `open(path)` maps a file. See
+/// `contiguousStorage` for which datasets can be mapped.
+template <class T, class F>
+MappedValues mapValues(const HighFive::DataSet& dset, F open) {
+    const auto storage = contiguousStorage<T>(dset);
+    if (storage.offset == HADDR_UNDEF) {
         return {};
     }
 
-    constexpr size_t min_gap_size = SONATA_PAGESIZE / sizeof(T);
-    constexpr size_t max_aggregated_block_size = 1 * min_gap_size;
+    MappedValues values{open(storage.path)};
+    if (values.file == nullptr ||
+        storage.offset + dset.getElementCount() * sizeof(T) > values.file->size()) {
+        return {};
+    }
+    values.data = values.file->data() + storage.offset;
+    return values;
+}
+
+/// Copy the canonical `selection` of the mapped `values` to `out`, holding
+/// `lock` only while locating them.
+///
+/// Returns `false`, without reading anything, if `dset` can't be mapped or the
+/// selection is out of bounds.
+template <class T>
+bool readMappedSelectionInto(const HighFive::DataSet& dset,
+                             const Selection& selection,
+                             MappedFiles& files,
+                             const Hdf5ReaderOptions& options,
+                             const Hdf5Lock& lock,
+                             T* out) {
+    const auto& ranges = selection.ranges();
+    MappedValues values;
+    {
+        HDF5_LOCK_GUARD(lock)
+        if (!ranges.empty() && std::get<1>(ranges.back()) > dset.getElementCount()) {
+            return false;
+        }
+        values = mapValues<T>(dset, [&files](const std::string& path) { return files.get(path); });
+    }
+    if (values.data == nullptr) {
+        return false;
+    }
+
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(selection.flatSize());
+    recorder.read(selection.flatSize(), [&] {
+        for (const auto& range : ranges) {
+            const size_t n = std::get<1>(range) - std::get<0>(range);
+            std::memcpy(static_cast<void*>(out),
+                        values.data + std::get<0>(range) * sizeof(T),
+                        n * sizeof(T));
+            out += n;
+        }
+    });
+    return true;
+}
+
+// A read submitted with io_uring costs about as much as the `pread` HDF5 does
+// for one block, without the overhead of an HDF5 call. Hence, merging across
+// more than a page saves next to nothing and reads bytes that are discarded.
+const size_t io_uring_max_gap_bytes = 4096;
+
+/// Read the canonical `selection` into `out` with io_uring, bypassing HDF5.
+///
+/// The ranges are merged into blocks as for HDF5, though only across gaps of
+/// up to `io_uring_max_gap_bytes`, then all blocks are submitted at once.
+/// Blocks consisting of a single range are read straight into `out`, all
+/// others into a buffer from which the ranges are extracted.
+///
+/// Returns `false`, without reading anything, if the values of `dset` aren't
+/// stored contiguously, see `contiguousStorage`, or the selection is out of
+/// bounds. `lock` is only held while locating the values.
+template <class T>
+bool readIoUringSelectionInto(const HighFive::DataSet& dset,
+                              const Selection& selection,
+                              IoUringReader& io_uring,
+                              const Hdf5ReaderOptions& options,
+                              const Hdf5Lock& lock,
+                              T* out) {
+    const auto& ranges = selection.ranges();
+    ContiguousStorage storage;
+    {
+        HDF5_LOCK_GUARD(lock)
+        if (!ranges.empty() && std::get<1>(ranges.back()) > dset.getElementCount()) {
+            return false;
+        }
+        storage = contiguousStorage<T>(dset);
+    }
+    if (storage.offset == HADDR_UNDEF) {
+        return false;
+    }
+
+    const auto params = mergeParameters(dset,
+                                        sizeof(T),
+                                        std::min(options.min_gap_bytes, io_uring_max_gap_bytes),
+                                        options.max_aggregated_block_bytes,
+                                        false);
+    const auto blocks = mergedBlocks(ranges, params);
+
+    // Blocks consisting of a single range are read straight into `out`, all
+    // others into `buffer`; `offsets` are relative to either.
+    std::vector<bool> direct;
+    std::vector<size_t> offsets;
+    direct.reserve(blocks.size());
+    offsets.reserve(blocks.size());
+    size_t n_out = 0;
+    size_t n_buffered = 0;
+    size_t i_range = 0;
+    for (const auto& block : blocks) {
+        const size_t n = std::get<1>(block) - std::get<0>(block);
+        direct.push_back(ranges[i_range] == block);
+        if (direct.back()) {
+            offsets.push_back(n_out);
+            n_out += n;
+            ++i_range;
+            continue;
+        }
+
+        offsets.push_back(n_buffered);
+        n_buffered += n;
+        for (; i_range < ranges.size() && std::get<1>(ranges[i_range]) <= std::get<1>(block);
+             ++i_range) {
+            n_out += std::get<1>(ranges[i_range]) - std::get<0>(ranges[i_range]);
+        }
+    }
+    std::vector<T> buffer(n_buffered);
+
+    std::vector<IoUringReader::Request> requests;
+    requests.reserve(blocks.size());
+    size_t n_read = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const size_t n = std::get<1>(blocks[i]) - std::get<0>(blocks[i]);
+        T* block_out = (direct[i] ? out : buffer.data()) + offsets[i];
+        requests.push_back({storage.offset + std::get<0>(blocks[i]) * sizeof(T),
+                            n * sizeof(T),
+                            reinterpret_cast<char*>(block_out)});
+        n_read += n;
+    }
+
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(selection.flatSize());
+    recorder.read(n_read, [&] { io_uring.read(storage.path, requests); });
+
+    // Extract the ranges of the buffered blocks.
+    i_range = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const auto& block = blocks[i];
+        if (direct[i]) {
+            out += std::get<1>(block) - std::get<0>(block);
+            ++i_range;
+            continue;
+        }
+
+        const T* values = buffer.data() + offsets[i];
+        for (; i_range < ranges.size() && std::get<1>(ranges[i_range]) <= std::get<1>(block);
+             ++i_range) {
+            const auto& range = ranges[i_range];
+            const size_t n = std::get<1>(range) - std::get<0>(range);
+            std::copy_n(values + (std::get<0>(range) - std::get<0>(block)), n, out);
+            out += n;
+        }
+    }
+    return true;
+}
+
+template <class T>
+bool readChunksInto(const HighFive::DataSet&,
+                    const Selection&,
+                    const Hdf5ReaderOptions&,
+                    const Hdf5Lock&,
+                    T*,
+                    std::false_type /* is_arithmetic */) {
+    return false;
+}
+
+template <class T>
+bool readChunksInto(const HighFive::DataSet& dset,
+                    const Selection& selection,
+                    const Hdf5ReaderOptions& options,
+                    const Hdf5Lock& lock,
+                    T* out,
+                    std::true_type /* is_arithmetic */) {
+#if H5_VERSION_GE(1, 10, 5)
+    const auto& ranges = selection.ranges();
+    std::vector<H5Z_filter_t> filters;
+    hsize_t chunk_size = 0;
+    T fill_value{};
+    {
+        HDF5_LOCK_GUARD(lock)
+        const auto dcpl = dset.getCreatePropertyList();
+        if (H5Pget_layout(dcpl.getId()) != H5D_CHUNKED ||
+            dset.getSpace().getNumberDimensions() != 1 ||
+            std::get<1>(ranges.back()) > dset.getElementCount() ||
+            !(dset.getDataType() == HighFive::AtomicType<T>())) {
+            return false;
+        }
+
+        filters = revertibleFilters(dcpl.getId());
+        if (filters.empty() || H5Pget_chunk(dcpl.getId(), 1, &chunk_size) != 1) {
+            return false;
+        }
+
+        if (H5Pget_fill_value(dcpl.getId(), HighFive::AtomicType<T>().getId(), &fill_value) < 0) {
+            throw SonataError("Failed to query the fill value");
+        }
+    }
+
+    // The part of a range within one chunk, and where its values go in `out`.
+    struct Piece {
+        size_t begin;
+        size_t end;
+        size_t offset;
+    };
+    std::vector<Piece> pieces;
+    // The index of each chunk to read, and its first piece.
+    std::vector<std::pair<size_t, size_t>> chunks;
+
+    size_t offset = 0;
+    for (const auto& range : ranges) {
+        for (size_t begin = std::get<0>(range); begin < std::get<1>(range);) {
+            const size_t chunk = begin / chunk_size;
+            const size_t end = std::min<size_t>(std::get<1>(range), (chunk + 1) * chunk_size);
+            if (chunks.empty() || chunks.back().first != chunk) {
+                chunks.emplace_back(chunk, pieces.size());
+            }
+            pieces.push_back({begin, end, offset});
+            offset += end - begin;
+            begin = end;
+        }
+    }
+    chunks.emplace_back(0, pieces.size());
+
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(selection.flatSize());
+
+    const size_t n_threads = options.n_decompression_threads;
+    std::vector<std::vector<char>> raw(n_threads);
+    std::vector<std::vector<char>> scratch(n_threads);
+
+    bulk_read::parallelFor(
+        chunks.size() - 1,
+        [&](size_t thread_id, size_t c) {
+            hsize_t chunk_offset = chunks[c].first * chunk_size;
+            const size_t chunk_bytes = chunk_size * sizeof(T);
+            auto& chunk = raw[thread_id];
+
+            uint32_t filter_mask = 0;
+            hsize_t n_bytes = 0;
+            {
+                // Only the raw reads take the lock, decompression runs in parallel.
+                HDF5_LOCK_GUARD(lock)
+                unsigned stored_mask = 0;
+                haddr_t address = HADDR_UNDEF;
+                if (H5Dget_chunk_info_by_coord(
+                        dset.getId(), &chunk_offset, &stored_mask, &address, &n_bytes) < 0) {
+                    throw SonataError("Failed to query the size of a chunk");
+                }
+                chunk.resize(n_bytes);
+                if (n_bytes > 0) {
+                    recorder.read(chunk_size, [&] {
+                        if (H5Dread_chunk(dset.getId(),
+                                          H5P_DEFAULT,
+                                          &chunk_offset,
+                                          &filter_mask,
+                                          chunk.data()) < 0) {
+                            throw SonataError("Failed to read a chunk");
+                        }
+                    });
+                }
+            }
+
+            if (n_bytes > 0) {
+                unfilterChunk(
+                    filters, filter_mask, sizeof(T), chunk_bytes, chunk, scratch[thread_id]);
+            }
+
+            for (size_t p = chunks[c].second; p < chunks[c + 1].second; ++p) {
+                const auto& piece = pieces[p];
+                const size_t n = piece.end - piece.begin;
+                if (n_bytes == 0) {
+                    // Chunks which were never written hold the fill value.
+                    std::fill_n(out + piece.offset, n, fill_value);
+                } else {
+                    std::memcpy(out + piece.offset,
+                                chunk.data() + (piece.begin - chunk_offset) * sizeof(T),
+                                n * sizeof(T));
+                }
+            }
+        },
+        n_threads);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Read the chunks of `selection` with `H5Dread_chunk` and decompress them on
+/// `options.n_decompression_threads` threads, holding `lock` only while reading.
+///
+/// Returns `false`, without reading anything, unless `dset` is one-dimensional,
+/// chunked, compressed with supported filters only and stored as `T`.
+template <class T>
+bool readChunksInto(const HighFive::DataSet& dset,
+                    const Selection& selection,
+                    const Hdf5ReaderOptions& options,
+                    const Hdf5Lock& lock,
+                    T* out) {
+    return readChunksInto(dset, selection, options, lock, out, std::is_arithmetic<T>());
+}
+
+/// Read the canonical `selection` into `out`, which must have room for
+/// `selection.flatSize()` values.
+///
+/// If `resources` are given, contiguous datasets are read from a memory map
+/// or with io_uring instead, if enabled. The lock of `options.locking` is
+/// only held around the HDF5 calls, see `Hdf5Lock::forRead`.
+template <class T>
+void readCanonicalSelectionInto(const HighFive::DataSet& dset,
+                                const Selection& selection,
+                                const Hdf5ReaderOptions& options,
+                                T* out,
+                                const ReaderResources* resources = nullptr) {
+    if (selection.empty()) {
+        return;
+    }
+
+    const auto lock = Hdf5Lock::forRead(options.locking, dset);
+    if (resources != nullptr && resources->mapped_files != nullptr &&
+        readMappedSelectionInto(dset, selection, *resources->mapped_files, options, lock, out)) {
+        return;
+    }
+
+    if (resources != nullptr && resources->io_uring != nullptr &&
+        readIoUringSelectionInto(dset, selection, *resources->io_uring, options, lock, out)) {
+        return;
+    }
+
+    if (options.n_decompression_threads > 0 &&
+        readChunksInto(dset, selection, options, lock, out)) {
+        return;
+    }
+
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(selection.flatSize());
+
+    const auto params = [&] {
+        HDF5_LOCK_GUARD(lock)
+        return mergeParameters(dset,
+                               sizeof(T),
+                               options.min_gap_bytes,
+                               options.max_aggregated_block_bytes,
+                               options.chunk_aware);
+    }();
+
+    const auto& ranges = selection.ranges();
+    auto blocks = mergedBlocks(ranges, params);
+    if (options.block_cache == nullptr &&
+        useHyperslab(ranges, blocks, params, sizeof(T), options.read_mode)) {
+        HDF5_LOCK_GUARD(lock)
+        recorder.read(selection.flatSize(),
+                      [&] { readInto(dset.select(_makeHyperslab(ranges)), out); });
+        return;
+    }
 
     auto readBlock = [&](auto& buffer, const auto& range) {
         size_t i_begin = std::get<0>(range);
         size_t i_end = std::get<1>(range);
-        dset.select({i_begin}, {i_end - i_begin}).read(buffer);
+        HDF5_LOCK_GUARD(lock)
+        recorder.read(i_end - i_begin,
+                      [&] { dset.select({i_begin}, {i_end - i_begin}).read(buffer); });
     };
 
-    return bulk_read::bulkRead<T>([&readBlock](auto& buffer,
-                                               const auto& range) { readBlock(buffer, range); },
-                                  selection.ranges(),
-                                  min_gap_size,
-                                  max_aggregated_block_size);
+    auto readBlockInto = [&](T* block_out, const auto& range) {
+        size_t i_begin = std::get<0>(range);
+        size_t i_end = std::get<1>(range);
+        HDF5_LOCK_GUARD(lock)
+        recorder.read(i_end - i_begin, [&] {
+            readInto(dset.select({i_begin}, {i_end - i_begin}), block_out);
+        });
+    };
+
+    if (options.block_cache != nullptr) {
+        auto& cache = *options.block_cache;
+        const auto block_size = std::max<size_t>(1, cache.blockBytes() / sizeof(T));
+        size_t n_elements = 0;
+        Hdf5BlockCache::Key key{std::string(), std::string(), typeid(T).name(), 0, 0};
+        {
+            HDF5_LOCK_GUARD(lock)
+            n_elements = dset.getElementCount();
+            key.file = dset.getFile().getName();
+            key.dataset = dset.getPath();
+        }
+        const auto cached_blocks = bulk_read::alignedBlocks(ranges, block_size, n_elements);
+
+        auto cachedBlock = [&](const auto& range) {
+            auto block_key = key;
+            block_key.begin = std::get<0>(range);
+            block_key.end = std::get<1>(range);
+            if (auto cached = cache.find(block_key)) {
+                return std::static_pointer_cast<const std::vector<T>>(cached);
+            }
+
+            auto block = std::make_shared<std::vector<T>>();
+            readBlock(*block, range);
+            cache.insert(block_key, block, blockBytes(*block));
+            return std::shared_ptr<const std::vector<T>>(std::move(block));
+        };
+
+        readBlocksInto(
+            [&](auto& buffer, const auto& range) {
+                const auto block = cachedBlock(range);
+                buffer.assign(block->begin(), block->end());
+            },
+            [&](T* block_out, const auto& range) {
+                const auto block = cachedBlock(range);
+                std::copy(block->begin(), block->end(), block_out);
+            },
+            cached_blocks,
+            bulk_read::splitSubranges(cached_blocks, ranges),
+            options,
+            out);
+        return;
+    }
+
+    if (options.n_reader_threads > 1 || options.prefetch_depth > 0) {
+        // Reading e.g. a whole column is a single range; split it so that
+        // reading and extracting can overlap.
+        auto subranges = ranges;
+        bulk_read::splitLargeBlocks(blocks, subranges, params.max_aggregated_block_size);
+        readBlocksInto(readBlock, readBlockInto, blocks, subranges, options, out);
+        return;
+    }
+
+    bulk_read::bulkReadInto(readBlock, readBlockInto, blocks, ranges, out);
 }
 
 template <class T>
 std::vector<T> readCanonicalSelection(const HighFive::DataSet& dset,
-                                      const Selection& xsel,
-                                      const Selection& ysel) {
+                                      const Selection& selection,
+                                      const Hdf5ReaderOptions& options,
+                                      const ReaderResources* resources = nullptr) {
+    std::vector<T> values(selection.flatSize());
+    readCanonicalSelectionInto(dset, selection, options, values.data(), resources);
+    return values;
+}
+
+/// The scalar type of the values in a two-dimensional dataset read as `T`.
+///
+/// A `T` is either a single value, or an `std::array` holding several
+/// consecutive values of one row.
+template <class T>
+struct Element2D {
+    using type = T;
+    static constexpr size_t size = 1;
+};
+
+template <class T, size_t N>
+struct Element2D<std::array<T, N>> {
+    using type = T;
+    static constexpr size_t size = N;
+};
+
+/// Copy the Cartesian product of the canonical `xsel` and `ysel` of the mapped
+/// values to `out`, see the one-dimensional `readMappedSelectionInto`.
+template <class T>
+bool readMappedSelectionInto(const HighFive::DataSet& dset,
+                             const Selection& xsel,
+                             const Selection& ysel,
+                             MappedFiles& files,
+                             const Hdf5ReaderOptions& options,
+                             const Hdf5Lock& lock,
+                             T* out) {
+    const auto& xranges = xsel.ranges();
+    const auto& yranges = ysel.ranges();
+    std::vector<size_t> dims;
+    MappedValues values;
+    {
+        HDF5_LOCK_GUARD(lock)
+        dims = dset.getDimensions();
+        if (dims.size() != 2 || std::get<1>(xranges.back()) > dims[0] ||
+            std::get<1>(yranges.back()) > dims[1]) {
+            return false;
+        }
+        values = mapValues<T>(dset, [&files](const std::string& path) { return files.get(path); });
+    }
+    if (values.data == nullptr) {
+        return false;
+    }
+
+    const size_t n_values = xsel.flatSize() * ysel.flatSize();
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(n_values);
+    recorder.read(n_values, [&] {
+        for (const auto& xrange : xranges) {
+            for (size_t i = std::get<0>(xrange); i < std::get<1>(xrange); ++i) {
+                for (const auto& yrange : yranges) {
+                    const size_t n = std::get<1>(yrange) - std::get<0>(yrange);
+                    const size_t offset = i * dims[1] + std::get<0>(yrange);
+                    std::memcpy(out, values.data + offset * sizeof(T), n * sizeof(T));
+                    out += n;
+                }
+            }
+        }
+    });
+    return true;
+}
+
+/// Read the Cartesian product of the canonical `xsel` and `ysel` into `out`
+/// with io_uring, see the one-dimensional `readIoUringSelectionInto`.
+///
+/// Every selected row is read as one block per merged block of columns, unless
+/// whole rows are selected, which are then read as one block per range of rows.
+template <class T>
+bool readIoUringSelectionInto(const HighFive::DataSet& dset,
+                              const Selection& xsel,
+                              const Selection& ysel,
+                              IoUringReader& io_uring,
+                              const Hdf5ReaderOptions& options,
+                              const Hdf5Lock& lock,
+                              T* out) {
+    const auto& xranges = xsel.ranges();
+    const auto& yranges = ysel.ranges();
+    std::vector<size_t> dims;
+    ContiguousStorage storage;
+    {
+        HDF5_LOCK_GUARD(lock)
+        dims = dset.getDimensions();
+        if (dims.size() != 2 || std::get<1>(xranges.back()) > dims[0] ||
+            std::get<1>(yranges.back()) > dims[1]) {
+            return false;
+        }
+        storage = contiguousStorage<T>(dset);
+    }
+    if (storage.offset == HADDR_UNDEF) {
+        return false;
+    }
+
+    const size_t n_columns = dims[1];
+    const size_t n_values = xsel.flatSize() * ysel.flatSize();
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(n_values);
+
+    std::vector<IoUringReader::Request> requests;
+    if (yranges.size() == 1 && ysel.flatSize() == n_columns) {
+        requests.reserve(xranges.size());
+        for (const auto& xrange : xranges) {
+            const size_t n = (std::get<1>(xrange) - std::get<0>(xrange)) * n_columns;
+            requests.push_back({storage.offset + std::get<0>(xrange) * n_columns * sizeof(T),
+                                n * sizeof(T),
+                                reinterpret_cast<char*>(out)});
+            out += n;
+        }
+
+        recorder.read(n_values, [&] { io_uring.read(storage.path, requests); });
+        return true;
+    }
+
+    const auto yparams = mergeParameters(dset,
+                                         sizeof(T),
+                                         std::min(options.min_gap_bytes, io_uring_max_gap_bytes),
+                                         options.max_aggregated_block_bytes_2d,
+                                         false,
+                                         1);
+    const auto yblocks = mergedBlocks(yranges, yparams);
+
+    // Without merged columns, rows are read straight into `out`.
+    const bool direct = yblocks == yranges;
+    const size_t row_size = bulk_read::detail::flatSize(yblocks);
+    const size_t n_rows = xsel.flatSize();
+    std::vector<T> buffer(direct ? 0 : n_rows * row_size);
+
+    requests.reserve(n_rows * yblocks.size());
+    T* row_out = direct ? out : buffer.data();
+    for (const auto& xrange : xranges) {
+        for (size_t i = std::get<0>(xrange); i < std::get<1>(xrange); ++i) {
+            for (const auto& yblock : yblocks) {
+                const size_t n = std::get<1>(yblock) - std::get<0>(yblock);
+                requests.push_back(
+                    {storage.offset + (i * n_columns + std::get<0>(yblock)) * sizeof(T),
+                     n * sizeof(T),
+                     reinterpret_cast<char*>(row_out)});
+                row_out += n;
+            }
+        }
+    }
+
+    recorder.read(n_rows * row_size, [&] { io_uring.read(storage.path, requests); });
+    if (direct) {
+        return true;
+    }
+
+    // Extract the selected columns of every row.
+    const T* row = buffer.data();
+    for (size_t i = 0; i < n_rows; ++i, row += row_size) {
+        size_t i_range = 0;
+        const T* block = row;
+        for (const auto& yblock : yblocks) {
+            for (; i_range < yranges.size() &&
+                   std::get<1>(yranges[i_range]) <= std::get<1>(yblock);
+                 ++i_range) {
+                const auto& yrange = yranges[i_range];
+                const size_t n = std::get<1>(yrange) - std::get<0>(yrange);
+                std::copy_n(block + (std::get<0>(yrange) - std::get<0>(yblock)), n, out);
+                out += n;
+            }
+            block += std::get<1>(yblock) - std::get<0>(yblock);
+        }
+    }
+    return true;
+}
+
+/// Read the Cartesian product of the canonical `xsel` and `ysel` into `out`, in
+/// row-major order. `out` must have room for `xsel.flatSize() * ysel.flatSize()`
+/// values.
+///
+/// If `resources` are given, contiguous datasets are read from a memory map
+/// or with io_uring instead, if enabled. As in one dimension, the lock is only
+/// held around the HDF5 calls.
+template <class T>
+void readCanonicalSelectionInto(const HighFive::DataSet& dset,
+                                const Selection& xsel,
+                                const Selection& ysel,
+                                const Hdf5ReaderOptions& options,
+                                T* out,
+                                const ReaderResources* resources = nullptr) {
+    static_assert(std::is_arithmetic<T>::value, "Only numeric 2D datasets are supported.");
+
     const auto& xranges = xsel.ranges();
     const auto& yranges = ysel.ranges();
-    if (yranges.size() != 1) {
-        throw SonataError("Only yranges.size() == 1 has been implemented.");
+    if (xranges.empty() || yranges.empty()) {
+        return;
     }
 
-    size_t j_begin = std::get<0>(yranges[0]);
-    size_t j_end = std::get<1>(yranges[0]);
+    const auto lock = Hdf5Lock::forRead(options.locking, dset);
+    if (resources != nullptr && resources->mapped_files != nullptr &&
+        readMappedSelectionInto(dset, xsel, ysel, *resources->mapped_files, options, lock, out)) {
+        return;
+    }
+
+    if (resources != nullptr && resources->io_uring != nullptr &&
+        readIoUringSelectionInto(dset, xsel, ysel, *resources->io_uring, options, lock, out)) {
+        return;
+    }
+
+    const ReadRecorder recorder(dset, options, lock);
+    recorder.request(xsel.flatSize() * ysel.flatSize());
+
+    // Columns are merged to read fewer, wider blocks; rows are then merged
+    // based on the number of bytes per row of these blocks.
+    const auto yparams = [&] {
+        HDF5_LOCK_GUARD(lock)
+        return mergeParameters(dset,
+                               sizeof(T),
+                               options.min_gap_bytes,
+                               options.max_aggregated_block_bytes_2d,
+                               options.chunk_aware,
+                               1);
+    }();
+    const auto yblocks = mergedBlocks(yranges, yparams);
+
+    const auto xparams = [&] {
+        HDF5_LOCK_GUARD(lock)
+        return mergeParameters(dset,
+                               sizeof(T) * bulk_read::detail::flatSize(yblocks),
+                               options.min_gap_bytes,
+                               options.max_aggregated_block_bytes_2d,
+                               options.chunk_aware,
+                               0);
+    }();
+    const auto xblocks = mergedBlocks(xranges, xparams);
 
-    constexpr size_t min_gap_size = SONATA_PAGESIZE / (2 * sizeof(uint64_t));
-    constexpr size_t max_aggregated_block_size = 128 * min_gap_size;
+    auto select = [&dset](const Selection::Range& xblock, const Selection::Range& yblock) {
+        const size_t i_begin = std::get<0>(xblock);
+        const size_t j_begin = std::get<0>(yblock);
+        return dset.select({i_begin, j_begin},
+                           {std::get<1>(xblock) - i_begin, std::get<1>(yblock) - j_begin});
+    };
+
+    auto blockSize = [](const Selection::Range& xblock, const Selection::Range& yblock) {
+        return (std::get<1>(xblock) - std::get<0>(xblock)) *
+               (std::get<1>(yblock) - std::get<0>(yblock));
+    };
 
-    auto readBlock = [&](auto& buffer, const auto& xrange) {
-        size_t i_begin = std::get<0>(xrange);
-        size_t i_end = std::get<1>(xrange);
-        dset.select({i_begin, j_begin}, {i_end - i_begin, j_end - j_begin}).read(buffer);
+    auto readBlock = [&](std::vector<T>& buffer, const auto& xblock, const auto& yblock) {
+        buffer.resize(blockSize(xblock, yblock));
+        HDF5_LOCK_GUARD(lock)
+        recorder.read(buffer.size(), [&] { readInto(select(xblock, yblock), buffer.data()); });
     };
 
-    return bulk_read::bulkRead<T>([&readBlock](auto& buffer,
-                                               const auto& range) { readBlock(buffer, range); },
-                                  xranges,
-                                  min_gap_size,
-                                  max_aggregated_block_size);
+    auto readBlockInto = [&](T* block_out, const auto& xblock, const auto& yblock) {
+        HDF5_LOCK_GUARD(lock)
+        recorder.read(blockSize(xblock, yblock),
+                      [&] { readInto(select(xblock, yblock), block_out); });
+    };
+
+    bulk_read::bulkReadInto2D(readBlock, readBlockInto, xblocks, xranges, yblocks, yranges, out);
+}
+
+template <class T>
+std::vector<T> readCanonicalSelection(const HighFive::DataSet& dset,
+                                      const Selection& xsel,
+                                      const Selection& ysel,
+                                      const Hdf5ReaderOptions& options,
+                                      const ReaderResources* resources = nullptr) {
+    using Element = typename Element2D<T>::type;
+    constexpr size_t n_elements = Element2D<T>::size;
+    static_assert(sizeof(T) == n_elements * sizeof(Element), "T must not have padding.");
+
+    const size_t n_values = xsel.flatSize() * ysel.flatSize();
+    if (n_values % n_elements != 0) {
+        throw SonataError(
+            fmt::format("Can't read {} values into groups of {}.", n_values, n_elements));
+    }
+
+    std::vector<T> values(n_values / n_elements);
+    auto out = reinterpret_cast<Element*>(values.data());
+    readCanonicalSelectionInto(dset, xsel, ysel, options, out, resources);
+    return values;
 }
 
 }  // namespace detail
@@ -1,9 +1,10 @@
 #include <bbp/sonata/report_reader.h>
 #include <fmt/format.h>
 
-#include <algorithm>      // std::copy, std::find, std::lower_bound, std::upper_bound
-#include <iterator>       // std::advance, std::next
-#include <unordered_set>  // std::unordered_set
+#include <algorithm>  // std::copy, std::find, std::lower_bound, std::upper_bound
+#include <iterator>   // std::advance, std::next, std::prev
+
+#include "read_bulk.hpp"
 
 constexpr double EPSILON = 1e-6;
 
@@ -26,12 +27,22 @@ using bbp::sonata::Selection;
 using bbp::sonata::Spike;
 using bbp::sonata::Spikes;
 
+/// True if `node_id` is in `ranges`, which must be sorted and non-overlapping.
+bool containsNodeID(const Selection::Ranges& ranges, NodeID node_id) {
+    const auto it = std::upper_bound(ranges.begin(),
+                                     ranges.end(),
+                                     node_id,
+                                     [](NodeID id, const Selection::Range& range) {
+                                         return id < std::get<0>(range);
+                                     });
+    return it != ranges.begin() && node_id < std::get<1>(*std::prev(it));
+}
+
 void filterNodeIDUnsorted(Spikes& spikes, const Selection& node_ids) {
-    const auto values = node_ids.flatten();
-    const auto selected_values = std::unordered_set<Selection::Value>(values.begin(), values.end());
+    const auto ranges = bbp::sonata::bulk_read::sortAndMerge(node_ids.ranges());
     const auto new_end =
-        std::remove_if(spikes.begin(), spikes.end(), [&selected_values](const Spike& spike) {
-            return selected_values.find(spike.first) == selected_values.end();
+        std::remove_if(spikes.begin(), spikes.end(), [&ranges](const Spike& spike) {
+            return !containsNodeID(ranges, spike.first);
         });
     spikes.erase(new_end, spikes.end());
 }
@@ -165,18 +176,17 @@ SpikeTimes SpikeReader::Population::getArrays(const nonstd::optional<Selection>&
                                               const nonstd::optional<double>& tstart,
                                               const nonstd::optional<double>& tstop) const {
     SpikeTimes filtered_spikes;
-    const auto& node_ids_selection = node_ids ? node_ids.value().flatten() : std::vector<NodeID>{};
+    const auto ranges = node_ids ? bulk_read::sortAndMerge(node_ids.value().ranges())
+                                 : Selection::Ranges{};
     // Create arrays directly for required data based on conditions
     for (size_t i = 0; i < spike_times_.node_ids.size(); ++i) {
         const auto& node_id = spike_times_.node_ids[i];
         const auto& timestamp = spike_times_.timestamps[i];
 
-        // Check if node_id is found in node_ids_selection
+        // Check if node_id is found in node_ids selection
         bool node_ids_found = true;
         if (node_ids) {
-            node_ids_found = std::find(node_ids_selection.begin(),
-                                       node_ids_selection.end(),
-                                       node_id) != node_ids_selection.end();
+            node_ids_found = containsNodeID(ranges, node_id);
         }
 
         // Check if timestamp is within valid range
@@ -371,9 +381,7 @@ ReportReader<T>::Population::getNodeIdElementLayout(
         result.node_index = node_index_;
         element_ids_count = node_offsets_.back();
     } else if (!node_ids->empty()) {
-        const auto selected_node_ids = node_ids->flatten();
-
-        for (const auto node_id : selected_node_ids) {
+        for (const auto node_id : *node_ids) {
             const auto it = std::lower_bound(node_index_.begin(),
                                              node_index_.end(),
                                              node_id,
@@ -510,7 +518,8 @@ DataFrame<T> ReportReader<T>::Population::get(
     const nonstd::optional<double>& tstart,
     const nonstd::optional<double>& tstop,
     const nonstd::optional<size_t>& tstride,
-    const nonstd::optional<size_t>& block_gap_limit) const {
+    const nonstd::optional<size_t>& block_gap_limit,
+    const nonstd::optional<size_t>& prefetch_depth) const {
     size_t index_start = 0;
     size_t index_stop = 0;
     std::tie(index_start, index_stop) = getIndex(tstart, tstop);
@@ -555,39 +564,67 @@ DataFrame<T> ReportReader<T>::Population::get(
                         dataset_type.string()));
     }
 
-    std::vector<float> buffer;
-    auto data_start = data_frame.data.begin();
-    for (size_t timer_index = index_start; timer_index <= index_stop; timer_index += stride) {
-        // Access the data in blocks to reduce the file system overhead
-        for (const auto& min_max_block : min_max_blocks) {
-            const auto first_index = node_index[std::get<0>(min_max_block)];
-            const auto last_index = node_index[std::get<1>(min_max_block) - 1];
-            const auto min = std::get<0>(node_ranges[first_index]);
-            const auto max = std::get<1>(node_ranges[last_index]);
-
-            dataset.select({timer_index, min}, {1, max - min}).read(buffer);
-
-            // Copy the values for each of the GIDs assigned into this block
-            const auto buffer_start = buffer.begin();
-            for (size_t i = std::get<0>(min_max_block); i < std::get<1>(min_max_block); ++i) {
-                const auto index = node_index[i];
-                const auto range = Selection::Range{std::get<0>(node_ranges[index]) - min,
-                                                    std::get<1>(node_ranges[index]) - min};
-                const auto elements_per_gid = (std::get<1>(range) - std::get<0>(range));
-                const auto offset = node_offsets[index];
-
-                // Soma report
-                if (elements_per_gid == 1) {
-                    data_start[offset] = buffer_start[std::get<0>(range)];
-                } else {  // Elements report
-                    std::copy(std::next(buffer_start, std::get<0>(range)),
-                              std::next(buffer_start, std::get<1>(range)),
-                              std::next(data_start, offset));
-                }
+    // Every timestep is read in `min_max_blocks.size()` blocks, the blocks
+    // of all timesteps are numbered consecutively.
+    const size_t n_blocks_per_time = min_max_blocks.size();
+    const size_t n_blocks = n_time_entries * n_blocks_per_time;
+
+    auto readBlock = [&](std::vector<float>& buffer, size_t i) {
+        const size_t timer_index = index_start + (i / n_blocks_per_time) * stride;
+        const auto& min_max_block = min_max_blocks[i % n_blocks_per_time];
+        const auto first_index = node_index[std::get<0>(min_max_block)];
+        const auto last_index = node_index[std::get<1>(min_max_block) - 1];
+        const auto min = std::get<0>(node_ranges[first_index]);
+        const auto max = std::get<1>(node_ranges[last_index]);
+
+        dataset.select({timer_index, min}, {1, max - min}).read(buffer);
+    };
+
+    auto extractBlock = [&](const std::vector<float>& buffer, size_t i) {
+        const auto data_start = std::next(data_frame.data.begin(),
+                                          (i / n_blocks_per_time) * element_ids_count);
+        const auto& min_max_block = min_max_blocks[i % n_blocks_per_time];
+        const auto min = std::get<0>(node_ranges[node_index[std::get<0>(min_max_block)]]);
+
+        // Copy the values for each of the GIDs assigned into this block
+        const auto buffer_start = buffer.begin();
+        for (size_t j = std::get<0>(min_max_block); j < std::get<1>(min_max_block); ++j) {
+            const auto index = node_index[j];
+            const auto range = Selection::Range{std::get<0>(node_ranges[index]) - min,
+                                                std::get<1>(node_ranges[index]) - min};
+            const auto elements_per_gid = (std::get<1>(range) - std::get<0>(range));
+            const auto offset = node_offsets[index];
+
+            // Soma report
+            if (elements_per_gid == 1) {
+                data_start[offset] = buffer_start[std::get<0>(range)];
+            } else {  // Elements report
+                std::copy(std::next(buffer_start, std::get<0>(range)),
+                          std::next(buffer_start, std::get<1>(range)),
+                          std::next(data_start, offset));
             }
         }
+    };
 
-        std::advance(data_start, element_ids_count);
+    const size_t depth = prefetch_depth.value_or(0);
+    if (depth == 0 || n_blocks <= 1) {
+        // Access the data in blocks to reduce the file system overhead
+        std::vector<float> buffer;
+        for (size_t i = 0; i < n_blocks; ++i) {
+            readBlock(buffer, i);
+            extractBlock(buffer, i);
+        }
+    } else {
+        // Read up to `depth` blocks ahead in a background thread, while
+        // extracting the values of the blocks already read.
+        std::vector<std::vector<float>> buffers(std::min(depth, n_blocks));
+        bulk_read::pipeline(
+            n_blocks,
+            [&](size_t, size_t i) { readBlock(buffers[i % buffers.size()], i); },
+            [&](size_t i) { extractBlock(buffers[i % buffers.size()], i); },
+            1,
+            buffers.size(),
+            true);
     }
 
     return data_frame;
@@ -2,6 +2,12 @@
 
 #include <fmt/format.h>
 
+#include <cstring>     // std::memcpy
+#include <functional>  // std::greater
+#include <limits>
+#include <queue>
+#include <thread>
+
 #include "read_bulk.hpp"
 
 namespace bbp {
@@ -24,22 +30,38 @@ Ranges _sortAndMerge(const Ranges& ranges) {
     return bulk_read::sortAndMerge(ranges);
 }
 
-Selection intersection_(const Ranges& lhs, const Ranges& rhs) {
-    if (lhs.empty() || rhs.empty()) {
-        return Selection({});
+/// The ranges of `selection` sorted and non-overlapping; only sorts if needed.
+Ranges _canonicalRanges(const Selection& selection) {
+    if (selection.isCanonical()) {
+        return selection.ranges();
     }
-    Ranges r0 = detail::_sortAndMerge(lhs);
-    Ranges r1 = detail::_sortAndMerge(rhs);
+    return _sortAndMerge(selection.ranges());
+}
+
+/// Append `[start, end)` to the sorted `ranges`, merging it with the last
+/// range if the two overlap or touch.
+void _appendCoalesced(Ranges& ranges, Selection::Value start, Selection::Value end) {
+    if (!ranges.empty() && start <= std::get<1>(ranges.back())) {
+        auto& last = std::get<1>(ranges.back());
+        last = std::max(last, end);
+    } else {
+        ranges.push_back({start, end});
+    }
+}
+
+// All of the following require `lhs` and `rhs` to be sorted and
+// non-overlapping; the result is sorted, non-overlapping and non-touching.
 
-    auto it0 = r0.cbegin();
-    auto it1 = r1.cbegin();
+Ranges intersection_(const Ranges& lhs, const Ranges& rhs) {
+    auto it0 = lhs.cbegin();
+    auto it1 = rhs.cbegin();
 
     Ranges ret;
-    while (it0 != r0.cend() && it1 != r1.cend()) {
+    while (it0 != lhs.cend() && it1 != rhs.cend()) {
         auto start = std::max(std::get<0>(*it0), std::get<0>(*it1));
         auto end = std::min(std::get<1>(*it0), std::get<1>(*it1));
         if (start < end) {
-            ret.push_back({start, end});
+            _appendCoalesced(ret, start, end);
         }
 
         if (std::get<1>(*it0) < std::get<1>(*it1)) {
@@ -49,15 +71,573 @@ Selection intersection_(const Ranges& lhs, const Ranges& rhs) {
         }
     }
 
-    return Selection(std::move(ret));
+    return ret;
+}
+
+Ranges union_(const Ranges& lhs, const Ranges& rhs) {
+    auto it0 = lhs.cbegin();
+    auto it1 = rhs.cbegin();
+
+    Ranges ret;
+    ret.reserve(lhs.size() + rhs.size());
+    while (it0 != lhs.cend() || it1 != rhs.cend()) {
+        if (it1 == rhs.cend() ||
+            (it0 != lhs.cend() && std::get<0>(*it0) <= std::get<0>(*it1))) {
+            _appendCoalesced(ret, std::get<0>(*it0), std::get<1>(*it0));
+            ++it0;
+        } else {
+            _appendCoalesced(ret, std::get<0>(*it1), std::get<1>(*it1));
+            ++it1;
+        }
+    }
+
+    return ret;
+}
+
+Ranges difference_(const Ranges& lhs, const Ranges& rhs) {
+    auto it1 = rhs.cbegin();
+
+    Ranges ret;
+    for (const auto& range : lhs) {
+        auto start = std::get<0>(range);
+        const auto end = std::get<1>(range);
+
+        // `rhs` ranges ending before `start` can't affect this or any later range.
+        while (it1 != rhs.cend() && std::get<1>(*it1) <= start) {
+            ++it1;
+        }
+
+        for (auto it = it1; it != rhs.cend() && std::get<0>(*it) < end && start < end; ++it) {
+            if (start < std::get<0>(*it)) {
+                _appendCoalesced(ret, start, std::get<0>(*it));
+            }
+            start = std::max(start, std::get<1>(*it));
+        }
+
+        if (start < end) {
+            _appendCoalesced(ret, start, end);
+        }
+    }
+
+    return ret;
+}
+
+/// Runs of consecutive values in `[first, last)`, as in `Selection::fromValues`.
+///
+/// Once a run is long enough, the next `block_size` values are compared
+/// against the expected continuation of the run in one branch-free loop,
+/// which the compiler vectorizes. If that fails the following `block_size`
+/// values are handled one by one, so short runs don't pay for the check.
+Ranges _runsFromValues(const Selection::Value* first, const Selection::Value* last) {
+    constexpr size_t block_size = 32;
+
+    Ranges ranges;
+    Selection::Value start = 0;
+    Selection::Value end = 0;
+    size_t scalar_count = 0;
+    while (first != last) {
+        if (scalar_count == 0 && end - start >= block_size &&
+            static_cast<size_t>(last - first) >= block_size) {
+            Selection::Value mismatch = 0;
+            for (size_t j = 0; j < block_size; ++j) {
+                mismatch |= first[j] ^ (end + j);
+            }
+            if (mismatch == 0) {
+                end += block_size;
+                first += block_size;
+                continue;
+            }
+            scalar_count = block_size;
+        }
+
+        const auto v = *first;
+        if (v == end) {
+            ++end;
+        } else {
+            if (start < end) {
+                ranges.push_back({start, end});
+            }
+            start = v;
+            end = v + 1;
+        }
+        ++first;
+        if (scalar_count > 0) {
+            --scalar_count;
+        }
+    }
+
+    if (start < end) {
+        ranges.push_back({start, end});
+    }
+
+    return ranges;
+}
+
+/// As `_runsFromValues`, but split into `n_threads` chunks processed concurrently.
+Ranges _runsFromValues(const Selection::Value* first,
+                       const Selection::Value* last,
+                       size_t n_threads) {
+    const auto n_values = static_cast<size_t>(last - first);
+    const size_t min_chunk_size = 1 << 16;
+    n_threads = std::min(n_threads, n_values / min_chunk_size);
+    if (n_threads <= 1) {
+        return _runsFromValues(first, last);
+    }
+
+    std::vector<Ranges> chunks(n_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    const size_t chunk_size = (n_values + n_threads - 1) / n_threads;
+    const auto chunkRuns = [&](size_t i) {
+        const auto begin = first + std::min(i * chunk_size, n_values);
+        const auto end = first + std::min((i + 1) * chunk_size, n_values);
+        chunks[i] = _runsFromValues(begin, end);
+    };
+    for (size_t i = 1; i < n_threads; ++i) {
+        threads.emplace_back(chunkRuns, i);
+    }
+    chunkRuns(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t n_ranges = 0;
+    for (const auto& chunk : chunks) {
+        n_ranges += chunk.size();
+    }
+
+    // A run crossing a chunk border ends one chunk and starts the next.
+    Ranges ret;
+    ret.reserve(n_ranges);
+    for (const auto& chunk : chunks) {
+        auto it = chunk.begin();
+        if (it != chunk.end() && !ret.empty() && std::get<1>(ret.back()) == std::get<0>(*it)) {
+            std::get<1>(ret.back()) = std::get<1>(*it);
+            ++it;
+        }
+        ret.insert(ret.end(), it, chunk.end());
+    }
+
+    return ret;
+}
+
+Ranges _runsFromMask(const uint8_t* mask, size_t n) {
+    const auto load = [mask](size_t i) {
+        uint64_t word;
+        std::memcpy(&word, mask + i, sizeof(word));
+        return word;
+    };
+    // true if none of the 8 bytes of `word` is zero
+    const auto allNonZero = [](uint64_t word) {
+        return ((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL) == 0;
+    };
+
+    Ranges ranges;
+    size_t i = 0;
+    while (i < n) {
+        while (i + 8 <= n && load(i) == 0) {
+            i += 8;
+        }
+        while (i < n && mask[i] == 0) {
+            ++i;
+        }
+        if (i == n) {
+            break;
+        }
+
+        const auto start = i;
+        while (i + 8 <= n && allNonZero(load(i))) {
+            i += 8;
+        }
+        while (i < n && mask[i] != 0) {
+            ++i;
+        }
+        ranges.push_back({start, i});
+    }
+
+    return ranges;
+}
+
+namespace serialization {
+// Format of `Selection::serialize`, all integers are LEB128 varints:
+//
+//   version, number of ranges, records...
+//
+// where each record starts with its kind and number of ranges `k`, and is
+// followed by:
+//   ranges: `k` times `zigzag(start - previous end), end - start`
+//   bitmap: `zigzag(start - previous end), number of bits`, then one bit per
+//           ID in `[start, end of the last range)`, least significant first.
+//
+// Bitmaps are only used for sorted ranges separated by gaps, such that the
+// runs of set bits are exactly the original ranges.
+const uint8_t version = 1;
+enum Kind : uint8_t { ranges = 0, bitmap = 1 };
+
+// Bitmaps are only considered for at least `min_bitmap_ranges` ranges with
+// gaps below `max_bitmap_gap`.
+const size_t min_bitmap_ranges = 8;
+const Selection::Value max_bitmap_gap = 256;
+
+uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ static_cast<uint64_t>(-static_cast<int64_t>(delta >> 63));
+}
+
+uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ static_cast<uint64_t>(-static_cast<int64_t>(value & 1));
+}
+
+size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void writeVarint(std::vector<uint8_t>& buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+class Reader
+{
+  public:
+    explicit Reader(const std::vector<uint8_t>& buffer)
+        : it_(buffer.data())
+        , end_(buffer.data() + buffer.size()) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = this->byte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw SonataError("Invalid serialized Selection: varint too long");
+    }
+
+    uint8_t byte() {
+        if (it_ == end_) {
+            throw SonataError("Invalid serialized Selection: unexpected end of buffer");
+        }
+        return *it_++;
+    }
+
+    const uint8_t* bytes(uint64_t count) {
+        if (static_cast<uint64_t>(end_ - it_) < count) {
+            throw SonataError("Invalid serialized Selection: unexpected end of buffer");
+        }
+        const auto* ret = it_;
+        it_ += count;
+        return ret;
+    }
+
+    bool done() const {
+        return it_ == end_;
+    }
+
+  private:
+    const uint8_t* it_;
+    const uint8_t* end_;
+};
+
+/// End of the window of ranges starting at `first` eligible for a bitmap.
+size_t bitmapWindowEnd(const Ranges& ranges, size_t first) {
+    size_t last = first + 1;
+    while (last < ranges.size()) {
+        const auto previous_end = std::get<1>(ranges[last - 1]);
+        const auto start = std::get<0>(ranges[last]);
+        if (start <= previous_end || start - previous_end >= max_bitmap_gap) {
+            break;
+        }
+        ++last;
+    }
+    return last;
+}
+
+size_t rangesSize(const Ranges& ranges, size_t first, size_t last, Selection::Value previous_end) {
+    size_t size = 0;
+    for (size_t i = first; i < last; ++i) {
+        size += varintSize(zigzag(std::get<0>(ranges[i]) - previous_end));
+        size += varintSize(std::get<1>(ranges[i]) - std::get<0>(ranges[i]));
+        previous_end = std::get<1>(ranges[i]);
+    }
+    return size;
+}
+
+void writeRanges(std::vector<uint8_t>& buffer,
+                 const Ranges& ranges,
+                 size_t first,
+                 size_t last,
+                 Selection::Value& previous_end) {
+    if (first == last) {
+        return;
+    }
+    writeVarint(buffer, Kind::ranges);
+    writeVarint(buffer, last - first);
+    for (size_t i = first; i < last; ++i) {
+        writeVarint(buffer, zigzag(std::get<0>(ranges[i]) - previous_end));
+        writeVarint(buffer, std::get<1>(ranges[i]) - std::get<0>(ranges[i]));
+        previous_end = std::get<1>(ranges[i]);
+    }
+}
+
+void writeBitmap(std::vector<uint8_t>& buffer,
+                 const Ranges& ranges,
+                 size_t first,
+                 size_t last,
+                 Selection::Value& previous_end) {
+    const auto start = std::get<0>(ranges[first]);
+    const auto n_bits = std::get<1>(ranges[last - 1]) - start;
+
+    writeVarint(buffer, Kind::bitmap);
+    writeVarint(buffer, last - first);
+    writeVarint(buffer, zigzag(start - previous_end));
+    writeVarint(buffer, n_bits);
+
+    const auto offset = buffer.size();
+    buffer.resize(offset + (n_bits + 7) / 8, 0);
+    for (size_t i = first; i < last; ++i) {
+        for (auto v = std::get<0>(ranges[i]) - start; v < std::get<1>(ranges[i]) - start; ++v) {
+            buffer[offset + v / 8] |= static_cast<uint8_t>(1u << (v % 8));
+        }
+    }
+    previous_end = std::get<1>(ranges[last - 1]);
+}
+
+std::vector<uint8_t> serialize(const Ranges& ranges) {
+    std::vector<uint8_t> buffer;
+    buffer.push_back(version);
+    writeVarint(buffer, ranges.size());
+
+    Selection::Value previous_end = 0;
+    size_t pending = 0;  // first range not yet written
+    size_t i = 0;
+    while (i < ranges.size()) {
+        const auto last = bitmapWindowEnd(ranges, i);
+        if (last - i >= min_bitmap_ranges) {
+            const auto start = std::get<0>(ranges[i]);
+            const auto n_bits = std::get<1>(ranges[last - 1]) - start;
+            const auto before = i == 0 ? 0 : std::get<1>(ranges[i - 1]);
+            if ((n_bits + 7) / 8 + varintSize(n_bits) < rangesSize(ranges, i, last, before)) {
+                writeRanges(buffer, ranges, pending, i, previous_end);
+                writeBitmap(buffer, ranges, i, last, previous_end);
+                pending = last;
+            }
+        }
+        i = last;
+    }
+    writeRanges(buffer, ranges, pending, ranges.size(), previous_end);
+
+    return buffer;
+}
+
+Ranges deserialize(const std::vector<uint8_t>& buffer) {
+    Reader reader(buffer);
+    if (reader.byte() != version) {
+        throw SonataError("Invalid serialized Selection: unknown version");
+    }
+
+    const auto n_ranges = reader.varint();
+    Ranges ranges;
+    // every range takes at least two bytes, don't trust `n_ranges` blindly
+    ranges.reserve(std::min<uint64_t>(n_ranges, buffer.size() / 2));
+
+    Selection::Value previous_end = 0;
+    while (ranges.size() < n_ranges) {
+        const auto kind = reader.varint();
+        const auto count = reader.varint();
+        if (count == 0 || count > n_ranges - ranges.size()) {
+            throw SonataError("Invalid serialized Selection: wrong number of ranges");
+        }
+
+        if (kind == Kind::ranges) {
+            for (uint64_t i = 0; i < count; ++i) {
+                const auto start = previous_end + unzigzag(reader.varint());
+                const auto end = start + reader.varint();
+                ranges.push_back({start, end});
+                previous_end = end;
+            }
+        } else if (kind == Kind::bitmap) {
+            const auto start = previous_end + unzigzag(reader.varint());
+            const auto n_bits = reader.varint();
+            const auto* bits = reader.bytes(n_bits / 8 + (n_bits % 8 != 0));
+
+            const auto n_before = ranges.size();
+            bool in_range = false;
+            for (uint64_t v = 0; v < n_bits; ++v) {
+                const bool set = (bits[v / 8] >> (v % 8)) & 1;
+                if (set && !in_range) {
+                    if (ranges.size() - n_before == count) {
+                        throw SonataError("Invalid serialized Selection: wrong number of ranges");
+                    }
+                    ranges.push_back({start + v, start + v + 1});
+                } else if (set) {
+                    ++std::get<1>(ranges.back());
+                }
+                in_range = set;
+            }
+            if (ranges.size() - n_before != count) {
+                throw SonataError("Invalid serialized Selection: wrong number of ranges");
+            }
+            previous_end = start + n_bits;
+        } else {
+            throw SonataError("Invalid serialized Selection: unknown record");
+        }
+    }
+
+    if (!reader.done()) {
+        throw SonataError("Invalid serialized Selection: trailing bytes");
+    }
+
+    return ranges;
 }
+}  // namespace serialization
+
+/// `n_parts + 1` IDs that cut the sorted `cost_ranges` into parts of nearly
+/// equal `flatSize`; part `i` is `[cuts[i], cuts[i + 1])`.
+std::vector<Selection::Value> _partitionCuts(const Ranges& cost_ranges, size_t n_parts) {
+    std::vector<Selection::Value> cuts;
+    cuts.reserve(n_parts + 1);
+    cuts.push_back(0);
+
+    const auto total = bulk_read::detail::flatSize(cost_ranges);
+    if (total == 0) {
+        cuts.resize(n_parts, 0);
+        cuts.push_back(std::numeric_limits<Selection::Value>::max());
+        return cuts;
+    }
+
+    auto it = cost_ranges.cbegin();
+    size_t offset = 0;  // flat index of the start of `*it`
+    for (size_t k = 1; k < n_parts; ++k) {
+        // k * total / n_parts, without overflow
+        const auto target = total / n_parts * k + total % n_parts * k / n_parts;
+        while (offset + (std::get<1>(*it) - std::get<0>(*it)) <= target) {
+            offset += std::get<1>(*it) - std::get<0>(*it);
+            ++it;
+        }
+        cuts.push_back(std::get<0>(*it) + (target - offset));
+    }
+
+    cuts.push_back(std::numeric_limits<Selection::Value>::max());
+    return cuts;
+}
+
+/// Split the sorted `ranges` at `cuts`.
+std::vector<Selection> _splitAt(const Ranges& ranges, const std::vector<Selection::Value>& cuts) {
+    std::vector<Ranges> parts(cuts.size() - 1);
+    size_t part = 0;
+    for (const auto& range : ranges) {
+        auto start = std::get<0>(range);
+        const auto end = std::get<1>(range);
+        while (start < end) {
+            while (cuts[part + 1] <= start) {
+                ++part;
+            }
+            const auto stop = std::min(end, cuts[part + 1]);
+            parts[part].push_back({start, stop});
+            start = stop;
+        }
+    }
+
+    std::vector<Selection> ret;
+    ret.reserve(parts.size());
+    for (auto& ranges : parts) {
+        ret.emplace_back(std::move(ranges));
+    }
+    return ret;
+}
+
+/// Canonical ranges of every Selection in `selections`.
+std::vector<Ranges> _canonicalRanges(const std::vector<Selection>& selections) {
+    std::vector<Ranges> ret;
+    ret.reserve(selections.size());
+    for (const auto& selection : selections) {
+        ret.push_back(_canonicalRanges(selection));
+    }
+    return ret;
+}
+
+Ranges unionAll_(const std::vector<Ranges>& inputs) {
+    // min-heap of (start of the next range, index of the input)
+    using Entry = std::pair<Selection::Value, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::vector<size_t> positions(inputs.size(), 0);
+
+    size_t count = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        count += inputs[i].size();
+        if (!inputs[i].empty()) {
+            heap.emplace(std::get<0>(inputs[i].front()), i);
+        }
+    }
 
-Selection union_(const Ranges& lhs, const Ranges& rhs) {
     Ranges ret;
-    std::copy(lhs.begin(), lhs.end(), std::back_inserter(ret));
-    std::copy(rhs.begin(), rhs.end(), std::back_inserter(ret));
-    ret = detail::_sortAndMerge(ret);
-    return Selection(std::move(ret));
+    ret.reserve(count);
+    while (!heap.empty()) {
+        const auto i = heap.top().second;
+        heap.pop();
+
+        const auto& range = inputs[i][positions[i]];
+        _appendCoalesced(ret, std::get<0>(range), std::get<1>(range));
+
+        if (++positions[i] < inputs[i].size()) {
+            heap.emplace(std::get<0>(inputs[i][positions[i]]), i);
+        }
+    }
+
+    return ret;
+}
+
+Ranges intersectAll_(const std::vector<Ranges>& inputs) {
+    if (inputs.empty()) {
+        return {};
+    }
+
+    // min-heap of (end of the current range, index of the input); every input
+    // has exactly one entry. Since the ranges of each input are sorted, the
+    // largest start among the current ranges never decreases.
+    using Entry = std::pair<Selection::Value, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::vector<size_t> positions(inputs.size(), 0);
+
+    Selection::Value max_start = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].empty()) {
+            return {};
+        }
+        heap.emplace(std::get<1>(inputs[i].front()), i);
+        max_start = std::max(max_start, std::get<0>(inputs[i].front()));
+    }
+
+    Ranges ret;
+    while (true) {
+        const auto end = heap.top().first;
+        const auto i = heap.top().second;
+        heap.pop();
+
+        if (max_start < end) {
+            _appendCoalesced(ret, max_start, end);
+        }
+
+        if (++positions[i] == inputs[i].size()) {
+            break;
+        }
+
+        const auto& range = inputs[i][positions[i]];
+        heap.emplace(std::get<1>(range), i);
+        max_start = std::max(max_start, std::get<0>(range));
+    }
+
+    return ret;
 }
 }  // namespace detail
 
@@ -65,6 +645,7 @@ Selection union_(const Ranges& lhs, const Ranges& rhs) {
 Selection::Selection(Selection::Ranges ranges)
     : ranges_(std::move(ranges)) {
     detail::_checkRanges(ranges_);
+    canonical_ = bulk_read::detail::isCanonical(ranges_);
 }
 
 
@@ -73,19 +654,64 @@ Selection Selection::fromValues(const Selection::Values& values) {
 }
 
 
+Selection Selection::fromValues(const Selection::Value* first,
+                                const Selection::Value* last,
+                                size_t n_threads) {
+    return Selection(detail::_runsFromValues(first, last, n_threads));
+}
+
+
+Selection Selection::fromMask(const uint8_t* mask, size_t n) {
+    return Selection(detail::_runsFromMask(mask, n));
+}
+
+
+Selection Selection::fromMask(const bool* mask, size_t n) {
+    static_assert(sizeof(bool) == sizeof(uint8_t), "bool must be one byte");
+    return fromMask(reinterpret_cast<const uint8_t*>(mask), n);
+}
+
+
+std::vector<Selection> Selection::partition(size_t n_parts) const {
+    return partitionByReadCost(n_parts, 0);
+}
+
+
+std::vector<Selection> Selection::partitionByReadCost(size_t n_parts,
+                                                      size_t min_gap_size,
+                                                      size_t max_aggregated_block_size) const {
+    if (n_parts == 0) {
+        throw SonataError("Can't partition a Selection into zero parts");
+    }
+
+    const auto ranges = detail::_canonicalRanges(*this);
+    const auto cost_ranges = min_gap_size == 0
+                                 ? ranges
+                                 : bulk_read::sortAndMerge(ranges,
+                                                           min_gap_size,
+                                                           max_aggregated_block_size);
+    return detail::_splitAt(ranges, detail::_partitionCuts(cost_ranges, n_parts));
+}
+
+
+Selection Selection::unionAll(const std::vector<Selection>& selections) {
+    return Selection(detail::unionAll_(detail::_canonicalRanges(selections)));
+}
+
+
+Selection Selection::intersectAll(const std::vector<Selection>& selections) {
+    return Selection(detail::intersectAll_(detail::_canonicalRanges(selections)));
+}
+
+
 const Selection::Ranges& Selection::ranges() const {
     return ranges_;
 }
 
 
 Selection::Values Selection::flatten() const {
-    Selection::Values result;
-    result.reserve(flatSize());
-    for (const auto& range : ranges_) {
-        for (auto v = std::get<0>(range); v < std::get<1>(range); ++v) {
-            result.emplace_back(v);
-        }
-    }
+    Selection::Values result(flatSize());
+    begin().fill(result.data(), result.size());
     return result;
 }
 
@@ -100,6 +726,21 @@ bool Selection::empty() const {
 }
 
 
+bool Selection::isCanonical() const {
+    return canonical_;
+}
+
+
+std::vector<uint8_t> Selection::serialize() const {
+    return detail::serialization::serialize(ranges_);
+}
+
+
+Selection Selection::deserialize(const std::vector<uint8_t>& buffer) {
+    return Selection(detail::serialization::deserialize(buffer));
+}
+
+
 bool operator==(const Selection& lhs, const Selection& rhs) {
     return lhs.ranges() == rhs.ranges();
 }
@@ -111,12 +752,35 @@ bool operator!=(const Selection& lhs, const Selection& rhs) {
 
 
 Selection operator&(const Selection& lhs, const Selection& rhs) {
-    return detail::intersection_(lhs.ranges(), rhs.ranges());
+    return Selection(
+        detail::intersection_(detail::_canonicalRanges(lhs), detail::_canonicalRanges(rhs)));
 }
 
 
 Selection operator|(const Selection& lhs, const Selection& rhs) {
-    return detail::union_(lhs.ranges(), rhs.ranges());
+    return Selection(
+        detail::union_(detail::_canonicalRanges(lhs), detail::_canonicalRanges(rhs)));
+}
+
+
+Selection operator-(const Selection& lhs, const Selection& rhs) {
+    return Selection(
+        detail::difference_(detail::_canonicalRanges(lhs), detail::_canonicalRanges(rhs)));
+}
+
+
+Selection operator^(const Selection& lhs, const Selection& rhs) {
+    const auto r0 = detail::_canonicalRanges(lhs);
+    const auto r1 = detail::_canonicalRanges(rhs);
+    return Selection(detail::union_(detail::difference_(r0, r1), detail::difference_(r1, r0)));
+}
+
+
+Selection complement(const Selection& selection, Selection::Value size) {
+    if (size == 0) {
+        return Selection({});
+    }
+    return Selection(detail::difference_({{0, size}}, detail::_canonicalRanges(selection)));
 }
 
 
@@ -0,0 +1,117 @@
+// Compares the time to read sparse selections of a one-dimensional dataset
+// with the default reader in each `ReadMode`, and using io_uring. The
+// thresholds of `ReadMode::automatic` were chosen by varying N_RANGES and
+// RANGE_SIZE.
+//
+// usage: benchmark_hdf5_reader FILE DATASET [N_RANGES] [RANGE_SIZE] [REPETITIONS]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bbp/sonata/hdf5_reader.h>
+
+using namespace bbp::sonata;
+
+namespace {
+Selection randomSelection(size_t n_elements, size_t n_ranges, size_t range_size) {
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<size_t> distribution(0, n_elements - 1);
+
+    std::vector<size_t> starts(n_ranges);
+    std::generate(starts.begin(), starts.end(), [&] { return distribution(rng); });
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    Selection::Ranges ranges;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        const size_t next = i + 1 < starts.size() ? starts[i + 1] : n_elements;
+        ranges.push_back({starts[i], std::min(starts[i] + range_size, next)});
+    }
+    return Selection(ranges);
+}
+
+double benchmark(const Hdf5Reader& reader,
+                 const HighFive::DataSet& dset,
+                 const Selection& selection,
+                 size_t repetitions,
+                 std::vector<double>& values) {
+    double best = 0.0;
+    for (size_t i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        values = reader.readSelection<double>(dset, selection);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0]
+                  << " FILE DATASET [N_RANGES] [RANGE_SIZE] [REPETITIONS]\n";
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    const std::string dataset = argv[2];
+    const size_t n_ranges = argc > 3 ? std::stoul(argv[3]) : 10000;
+    const size_t range_size = argc > 4 ? std::stoul(argv[4]) : 16;
+    const size_t repetitions = argc > 5 ? std::stoul(argv[5]) : 5;
+
+    const HighFive::File file(path);
+    const auto dset = file.getDataSet(dataset);
+    const auto selection = randomSelection(dset.getElementCount(), n_ranges, range_size);
+    std::cout << "Reading " << selection.ranges().size() << " ranges, "
+              << selection.flatSize() << " values, best of " << repetitions << "\n";
+
+    std::vector<double> expected;
+    const double default_time = benchmark(Hdf5Reader(), dset, selection, repetitions, expected);
+    std::cout << "default:  " << default_time << " s\n";
+
+    const std::vector<std::pair<const char*, Hdf5ReaderOptions::ReadMode>> read_modes = {
+        {"merge", Hdf5ReaderOptions::ReadMode::merge},
+        {"hyperslab", Hdf5ReaderOptions::ReadMode::hyperslab},
+        {"automatic", Hdf5ReaderOptions::ReadMode::automatic}};
+    for (const auto& read_mode : read_modes) {
+        Hdf5ReaderOptions options;
+        options.read_mode = read_mode.second;
+        options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+
+        std::vector<double> values;
+        const double time = benchmark(
+            Hdf5Reader(options), dset, selection, repetitions, values);
+        const auto stats = options.statistics->snapshot()[dset.getPath()];
+        std::cout << read_mode.first << ": " << time << " s, "
+                  << stats.n_read_calls / repetitions << " reads per selection"
+                  << (values == expected ? "" : ", MISMATCH") << "\n";
+        if (values != expected) {
+            return 1;
+        }
+    }
+
+    for (size_t queue_depth : {size_t(8), size_t(64), size_t(512)}) {
+        Hdf5ReaderOptions options;
+        options.io_uring_queue_depth = queue_depth;
+        options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+
+        std::vector<double> values;
+        const double time = benchmark(
+            Hdf5Reader(options), dset, selection, repetitions, values);
+        const auto stats = options.statistics->snapshot()[dset.getPath()];
+        std::cout << "io_uring (queue depth " << queue_depth << "): " << time << " s, "
+                  << stats.n_read_calls / repetitions << " reads per selection"
+                  << (values == expected ? "" : ", MISMATCH") << "\n";
+        if (values != expected) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
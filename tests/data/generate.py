@@ -1,6 +1,7 @@
 #!/usr/bin/env python
 
 import sys
+import zlib
 import numpy as np
 import h5py
 
@@ -227,9 +228,32 @@ def write_spikes(filepath):
         dtimestamps.attrs.create('units', data="ms", dtype=string_dtype)
         gpop_empty.create_dataset('node_ids', data=[], dtype=np.uint64)
 
+def write_compressed(filepath):
+    with h5py.File(filepath, 'w') as h5f:
+        h5f.create_dataset('values', data=np.arange(10000) * 0.5, dtype=np.double,
+                           chunks=(100,), compression='gzip', shuffle=True)
+        h5f.create_dataset('indices', data=np.arange(10000), dtype=np.int32,
+                           chunks=(128,), compression='gzip')
+
+        # Only chunks 2, 3 and 7 are written, all others hold the fill value.
+        sparse = h5f.create_dataset('sparse', shape=(1000,), dtype=np.double, chunks=(100,),
+                                    compression='gzip', shuffle=True, fillvalue=-1.0)
+        sparse[200:400] = np.arange(200, 400) * 0.5
+        sparse[700:800] = np.arange(700, 800) * 0.5
+
+        # Chunk 3 is stored without any filter, chunk 5 without the shuffle
+        # filter, as marked by their filter masks.
+        masked = h5f.create_dataset('masked', data=np.arange(1000) * 0.5, dtype=np.double,
+                                    chunks=(100,), compression='gzip', shuffle=True)
+        raw = (np.arange(300, 400) * 0.5).astype('<f8').tobytes()
+        masked.id.write_direct_chunk((300,), raw, filter_mask=0b11)
+        raw = (np.arange(500, 600) * 0.5).astype('<f8').tobytes()
+        masked.id.write_direct_chunk((500,), zlib.compress(raw), filter_mask=0b01)
+
 if __name__ == '__main__':
     write_nodes('nodes1.h5')
     write_edges('edges1.h5')
     write_spikes('spikes.h5')
     write_soma_report('somas.h5')
     write_element_report('elements.h5')
+    write_compressed('compressed.h5')
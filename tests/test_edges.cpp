@@ -133,6 +133,18 @@ TEST_CASE("EdgePopulation::writeIndices", "[edges]") {
             EdgePopulation::writeIndices(dstFilePath, "edges-AB", 4, 4, /* overwrite */ false),
             SonataError);
 
+        // Serialized with the populations of the file read with the same reader.
+        Hdf5ReaderOptions options;
+        options.locking = Hdf5ReaderOptions::Locking::per_file;
+        const Hdf5Reader reader(options);
+        {
+            const EdgePopulation population(dstFilePath, "", "edges-AB", reader);
+            CHECK(population.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+            CHECK_THROWS_AS(EdgePopulation::writeIndices(
+                                dstFilePath, "edges-AB", 4, 4, /* overwrite */ false, reader),
+                            SonataError);
+        }
+
         // Not implemented yet
         CHECK_THROWS_AS(
             EdgePopulation::writeIndices(dstFilePath, "edges-AB", 4, 4, /* overwrite */ true),
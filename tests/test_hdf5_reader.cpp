@@ -0,0 +1,265 @@
+#include <catch2/catch.hpp>
+
+#include <bbp/sonata/edges.h>
+#include <bbp/sonata/hdf5_reader.h>
+#include <bbp/sonata/report_reader.h>
+
+
+using namespace bbp::sonata;
+
+
+TEST_CASE("Hdf5Reader 2D", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto frame = reader.openPopulation("All").get();
+    const size_t n_cols = frame.ids.size();
+
+    const auto file = HighFive::File("./data/elements.h5");
+    const auto dset = file.getDataSet("/report/All/data");
+
+    const auto xsel = Selection({{1, 3}, {5, 6}, {8, 10}});
+    const auto ysel = Selection({{0, 2}, {10, 15}, {18, 20}, {99, 100}});
+
+    std::vector<float> expected;
+    for (const auto i : xsel.flatten()) {
+        for (const auto j : ysel.flatten()) {
+            expected.push_back(frame.data[i * n_cols + j]);
+        }
+    }
+
+    for (size_t min_gap_bytes : {size_t(0), size_t(16), size_t(4) << 20}) {
+        Hdf5ReaderOptions options;
+        options.min_gap_bytes = min_gap_bytes;
+        options.max_aggregated_block_bytes_2d = 64;
+        options.chunk_aware = false;
+
+        const Hdf5Reader hdf5_reader(options);
+        REQUIRE(hdf5_reader.readSelection<float>(dset, xsel, ysel) == expected);
+        REQUIRE(hdf5_reader.readSelection<double>(dset, xsel, Selection({{10, 11}})) ==
+                std::vector<double>{frame.data[1 * n_cols + 10],
+                                    frame.data[2 * n_cols + 10],
+                                    frame.data[5 * n_cols + 10],
+                                    frame.data[8 * n_cols + 10],
+                                    frame.data[9 * n_cols + 10]});
+    }
+
+    Hdf5ReaderOptions options;
+    options.memory_map = true;
+    const Hdf5Reader mapped_reader(options);
+    REQUIRE(mapped_reader.readSelection<float>(dset, xsel, ysel) == expected);
+    REQUIRE(mapped_reader.readSelection<double>(dset, xsel, Selection({{10, 11}})).size() == 5);
+}
+
+TEST_CASE("Hdf5Reader 2D io_uring", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto frame = reader.openPopulation("All").get();
+    const size_t n_cols = frame.ids.size();
+
+    const auto file = HighFive::File("./data/elements.h5");
+    const auto dset = file.getDataSet("/report/All/data");
+
+    const auto xsel = Selection({{1, 3}, {5, 6}, {8, 10}});
+    const auto ysel = Selection({{0, 2}, {10, 15}, {18, 20}, {99, 100}});
+
+    std::vector<float> expected;
+    std::vector<float> expected_rows;
+    for (const auto i : xsel.flatten()) {
+        for (const auto j : ysel.flatten()) {
+            expected.push_back(frame.data[i * n_cols + j]);
+        }
+        for (size_t j = 0; j < n_cols; ++j) {
+            expected_rows.push_back(frame.data[i * n_cols + j]);
+        }
+    }
+
+    // Contiguous, hence read with io_uring where available.
+    for (size_t min_gap_bytes : {size_t(0), size_t(4) << 20}) {
+        Hdf5ReaderOptions io_uring_options;
+        io_uring_options.io_uring_queue_depth = 4;
+        io_uring_options.min_gap_bytes = min_gap_bytes;
+        const Hdf5Reader io_uring_reader(io_uring_options);
+        REQUIRE(io_uring_reader.readSelection<float>(dset, xsel, ysel) == expected);
+        REQUIRE(io_uring_reader.readSelection<float>(dset, xsel, Selection({{0, n_cols}})) ==
+                expected_rows);
+    }
+}
+
+namespace {
+// A plugin implementing only what was required before numeric types were
+// added to `Hdf5Reader::supported_2D_types`.
+template <class T>
+class MinimalRead1D: virtual public Hdf5PluginRead1DInterface<T>
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        return Hdf5Reader().readSelection<T>(dset, selection);
+    }
+};
+
+class MinimalRead2D: virtual public Hdf5PluginRead2DInterface<std::array<uint64_t, 2>>
+{
+  public:
+    std::vector<std::array<uint64_t, 2>> readSelection(const HighFive::DataSet& dset,
+                                                       const Selection& xsel,
+                                                       const Selection& ysel) const override {
+        return Hdf5Reader().readSelection<std::array<uint64_t, 2>>(dset, xsel, ysel);
+    }
+};
+
+template <class T>
+class MinimalPlugin;
+
+template <class... Ts>
+class MinimalPlugin<std::tuple<Ts...>>
+    : virtual public Hdf5PluginInterface<Hdf5Reader::supported_1D_types,
+                                         Hdf5Reader::supported_2D_types>,
+      virtual public MinimalRead1D<Ts>...,
+      virtual public MinimalRead2D
+{
+  public:
+    HighFive::File openFile(const std::string& path) const override {
+        return HighFive::File(path);
+    }
+};
+}  // namespace
+
+TEST_CASE("Hdf5Reader 2D plugin defaults", "[base]") {
+    const Hdf5Reader reader(std::make_shared<MinimalPlugin<Hdf5Reader::supported_1D_types>>());
+
+    const auto edges = HighFive::File("./data/edges1.h5");
+    const auto index =
+        edges.getDataSet("/edges/edges-AB/indices/source_to_target/node_id_to_ranges");
+    const auto xsel = Selection({{0, 2}});
+    const auto ysel = Selection({{0, 2}});
+    REQUIRE(reader.readSelection<std::array<uint64_t, 2>>(index, xsel, ysel) ==
+            Hdf5Reader().readSelection<std::array<uint64_t, 2>>(index, xsel, ysel));
+
+    const auto file = HighFive::File("./data/elements.h5");
+    const auto dset = file.getDataSet("/report/All/data");
+    REQUIRE_THROWS_AS(reader.readSelection<float>(dset, xsel, ysel), SonataError);
+}
+
+namespace {
+// A plugin reading through a default `Hdf5Reader` which takes the global lock,
+// while populations call the plugin with their own lock held.
+const Hdf5Reader& globallyLockedReader() {
+    static const Hdf5Reader reader([] {
+        Hdf5ReaderOptions options;
+        options.locking = Hdf5ReaderOptions::Locking::global;
+        options.min_gap_bytes = 0;
+        options.n_reader_threads = 2;
+        return options;
+    }());
+    return reader;
+}
+
+template <class T>
+class ForwardingRead1D: virtual public Hdf5PluginRead1DInterface<T>
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        return globallyLockedReader().readSelection<T>(dset, selection);
+    }
+};
+
+template <class T>
+class ForwardingRead2D: virtual public Hdf5PluginRead2DInterface<T>
+{
+  public:
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& xsel,
+                                 const Selection& ysel) const override {
+        return globallyLockedReader().readSelection<T>(dset, xsel, ysel);
+    }
+};
+
+template <class T, class U>
+class ForwardingPlugin;
+
+template <class... Ts, class... Us>
+class ForwardingPlugin<std::tuple<Ts...>, std::tuple<Us...>>
+    : virtual public Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>,
+      virtual public ForwardingRead1D<Ts>...,
+      virtual public ForwardingRead2D<Us>...
+{
+  public:
+    HighFive::File openFile(const std::string& path) const override {
+        return HighFive::File(path);
+    }
+};
+}  // namespace
+
+TEST_CASE("Hdf5Reader plugin reading through a default reader", "[base]") {
+    // Without a thread-safe HDF5, both the population and the default reader
+    // take the global lock, which mustn't deadlock.
+    using Plugin =
+        ForwardingPlugin<Hdf5Reader::supported_1D_types, Hdf5Reader::supported_2D_types>;
+    const Hdf5Reader reader(std::make_shared<Plugin>());
+    const EdgePopulation population("./data/edges1.h5", "", "edges-AB", reader);
+
+    CHECK(population.sourceNodeIDs(Selection({{0, 3}, {4, 5}})) == std::vector<NodeID>{1, 1, 2, 3});
+    CHECK(population.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+    CHECK(population.efferentEdges({1, 3}) == Selection({{0, 2}, {4, 6}}));
+}
+
+TEST_CASE("Hdf5Reader compressed", "[base]") {
+    const auto file = HighFive::File("./data/compressed.h5");
+    const auto values = file.getDataSet("/values");
+    const auto indices = file.getDataSet("/indices");
+    const auto selection = Selection({{0, 1}, {99, 101}, {250, 1200}, {9990, 10000}});
+
+    std::vector<double> expected;
+    for (const auto i : selection.flatten()) {
+        expected.push_back(0.5 * static_cast<double>(i));
+    }
+
+    for (size_t n_decompression_threads : {size_t(1), size_t(4)}) {
+        Hdf5ReaderOptions options;
+        options.n_decompression_threads = n_decompression_threads;
+        options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+        const Hdf5Reader hdf5_reader(options);
+
+        REQUIRE(hdf5_reader.readSelection<double>(values, selection) == expected);
+        // One read per chunk of 100 values: chunks 0 to 11 and 99.
+        CHECK(options.statistics->snapshot()["/values"].n_read_calls == 13);
+
+        // Read with conversion, hence by HDF5.
+        const auto converted = hdf5_reader.readSelection<float>(values, selection);
+        CHECK(converted == std::vector<float>(expected.begin(), expected.end()));
+
+        const auto ids = hdf5_reader.readSelection<int32_t>(indices, selection);
+        CHECK(std::vector<uint64_t>(ids.begin(), ids.end()) == selection.flatten());
+    }
+}
+
+TEST_CASE("Hdf5Reader compressed, unwritten and unfiltered chunks", "[base]") {
+    const auto file = HighFive::File("./data/compressed.h5");
+    // Only chunks 2, 3 and 7, of 100 values each, were written.
+    const auto sparse = file.getDataSet("/sparse");
+    // Chunk 3 is stored unfiltered, chunk 5 without the shuffle filter.
+    const auto masked = file.getDataSet("/masked");
+    const auto selection = Selection({{0, 1}, {150, 420}, {480, 610}, {650, 1000}});
+
+    std::vector<double> expected_sparse;
+    std::vector<double> expected_masked;
+    for (const auto i : selection.flatten()) {
+        const bool written = (i >= 200 && i < 400) || (i >= 700 && i < 800);
+        expected_sparse.push_back(written ? 0.5 * static_cast<double>(i) : -1.0);
+        expected_masked.push_back(0.5 * static_cast<double>(i));
+    }
+
+    for (size_t n_decompression_threads : {size_t(0), size_t(1), size_t(4)}) {
+        Hdf5ReaderOptions options;
+        options.n_decompression_threads = n_decompression_threads;
+        options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+        const Hdf5Reader hdf5_reader(options);
+
+        CHECK(hdf5_reader.readSelection<double>(sparse, selection) == expected_sparse);
+        CHECK(hdf5_reader.readSelection<double>(masked, selection) == expected_masked);
+        if (n_decompression_threads > 0) {
+            // Chunks which were never written aren't read.
+            CHECK(options.statistics->snapshot()["/sparse"].n_read_calls == 3);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+
+#include <mpi.h>
+
+#include <bbp/sonata/mpi/hdf5_reader.h>
+#include <bbp/sonata/nodes.h>
+
+using namespace bbp::sonata;
+
+namespace {
+int rank() {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+}  // namespace
+
+TEST_CASE("CollectiveReader", "[mpi]") {
+    // Every rank reads a different selection; the last one reads nothing.
+    const auto selection = rank() == 0 ? Selection({{0, 2}, {4, 6}}) : Selection({});
+
+    for (bool two_phase_aggregation : {false, true}) {
+        mpi::CollectiveReaderOptions options;
+        options.two_phase_aggregation = two_phase_aggregation;
+        const auto reader = mpi::makeCollectiveReader(MPI_COMM_WORLD, options);
+
+        const NodePopulation expected("./data/nodes1.h5", "", "nodes-A");
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", reader);
+
+        CHECK(population.size() == expected.size());
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              expected.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              expected.getAttribute<std::string>("attr-Z", selection));
+    }
+}
+
+TEST_CASE("CollectiveReader2D", "[mpi]") {
+    const auto reader = mpi::makeCollectiveReader(MPI_COMM_WORLD);
+    const auto xsel = rank() == 0 ? Selection({{1, 3}, {8, 10}}) : Selection({{5, 6}});
+    const auto ysel = Selection({{0, 2}, {18, 20}, {99, 100}});
+
+    const auto expected_file = HighFive::File("./data/elements.h5");
+    const auto expected = Hdf5Reader().readSelection<float>(
+        expected_file.getDataSet("/report/All/data"), xsel, ysel);
+
+    const auto file = reader.openFile("./data/elements.h5");
+    const auto dset = file.getDataSet("/report/All/data");
+    CHECK(reader.readSelection<float>(dset, xsel, ysel) == expected);
+    CHECK(reader.readSelection<float>(dset, Selection({}), ysel).empty());
+}
+
+TEST_CASE("AggregatingReader", "[mpi]") {
+    const auto selection = rank() == 0 ? Selection({{0, 2}, {4, 6}})
+                                       : rank() == 1 ? Selection({{1, 5}}) : Selection({});
+    const auto xsel = rank() == 0 ? Selection({{1, 3}, {8, 10}}) : Selection({{2, 6}});
+    const auto ysel = rank() == 0 ? Selection({{0, 2}, {99, 100}}) : Selection({{1, 3}});
+
+    const auto expected_file = HighFive::File("./data/elements.h5");
+    const auto expected_2d = Hdf5Reader().readSelection<float>(
+        expected_file.getDataSet("/report/All/data"), xsel, ysel);
+
+    for (int group_size : {1, 2, 3}) {
+        mpi::AggregatingReaderOptions options;
+        options.group_size = group_size;
+        const auto reader = mpi::makeAggregatingReader(MPI_COMM_WORLD, options);
+
+        const NodePopulation expected("./data/nodes1.h5", "", "nodes-A");
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", reader);
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              expected.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              expected.getAttribute<std::string>("attr-Z", selection));
+
+        const auto file = reader.openFile("./data/elements.h5");
+        const auto dset = file.getDataSet("/report/All/data");
+        CHECK(reader.readSelection<float>(dset, xsel, ysel) == expected_2d);
+    }
+
+    CHECK_THROWS_AS(mpi::makeAggregatingReader(MPI_COMM_WORLD, {0, {}}), SonataError);
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    const int result = Catch::Session().run(argc, argv);
+    MPI_Finalize();
+    return result;
+}
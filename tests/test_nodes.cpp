@@ -2,8 +2,12 @@
 
 #include <bbp/sonata/nodes.h>
 
+#include <cstdio>
 #include <iostream>
+#include <numeric>
+#include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -149,6 +153,56 @@ TEST_CASE("NodePopulation", "[base]") {
 }
 
 
+TEST_CASE("NodePopulationgetAttributes", "[base]") {
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A");
+
+    for (const auto& selection : {Selection({{0, 2}, {4, 6}}),
+                                  Selection({{5, 6}, {0, 2}, {1, 3}}),
+                                  Selection({})}) {
+        const auto columns = population.getAttributes<uint64_t>({"attr-Y", "attr-X", "attr-Y"},
+                                                                selection);
+        REQUIRE(columns.size() == 3);
+        CHECK(columns[0] == population.getAttribute<uint64_t>("attr-Y", selection));
+        CHECK(columns[1] == population.getAttribute<uint64_t>("attr-X", selection));
+        CHECK(columns[2] == columns[0]);
+
+        const auto strings = population.getAttributes<std::string>({"attr-Z", "E-mapping-good"},
+                                                                   selection);
+        REQUIRE(strings.size() == 2);
+        CHECK(strings[0] == population.getAttribute<std::string>("attr-Z", selection));
+        CHECK(strings[1] == population.getAttribute<std::string>("E-mapping-good", selection));
+    }
+
+    CHECK(population.getAttributes<double>({}, Selection({{0, 1}})).empty());
+    CHECK_THROWS_AS(population.getAttributes<double>({"attr-X", "no-such-attribute"},
+                                                     Selection({{0, 1}})),
+                    SonataError);
+}
+
+TEST_CASE("NodePopulationgetAttributeInto", "[base]") {
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A");
+
+    for (const auto& selection : {Selection({{0, 6}}),
+                                  Selection({{0, 1}, {5, 6}}),
+                                  Selection({{5, 6}, {0, 2}, {1, 2}})}) {
+        std::vector<double> values(selection.flatSize() + 1, -1.0);
+        population.getAttributeInto<double>("attr-X", selection, values.data());
+
+        auto expected = population.getAttribute<double>("attr-X", selection);
+        expected.push_back(-1.0);
+        CHECK(values == expected);
+    }
+
+    std::vector<uint64_t> values(2);
+    population.getAttributeInto<uint64_t>("attr-Y", Selection({{0, 1}, {5, 6}}), values.data());
+    CHECK(values == std::vector<uint64_t>{21, 26});
+
+    CHECK_THROWS_AS(population.getAttributeInto<uint64_t>("no-such-attribute",
+                                                          Selection({{0, 1}}),
+                                                          values.data()),
+                    SonataError);
+}
+
 TEST_CASE("NodePopulationMove", "[base]") {
     NodePopulation population("./data/nodes1.h5", "", "nodes-A");
     NodePopulation pop2 = std::move(population);
@@ -160,6 +214,384 @@ TEST_CASE("NodePopulationSelectAll", "[base]") {
     CHECK(population.selectAll().flatSize() == 6);
 }
 
+TEST_CASE("NodePopulationOpensOnlyDataSets", "[base]") {
+    // Neither a group among the attributes, nor a missing `node_type_id`,
+    // keep the population from opening; they fail once accessed.
+    const std::string path = "./nodes-without-type-id.h5";
+    {
+        HighFive::File file(path, HighFive::File::Truncate);
+        file.createDataSet("/nodes/pop/0/attr-X", std::vector<double>{11.0, 12.0, 13.0});
+        file.createGroup("/nodes/pop/0/attr-group");
+        file.createGroup("/nodes/pop/some-group");
+    }
+
+    {
+        const NodePopulation population(path, "", "pop");
+        CHECK(population.attributeNames() == std::set<std::string>{"attr-X", "attr-group"});
+        CHECK(population.getAttribute<double>("attr-X", Selection({{1, 3}})) ==
+              std::vector<double>{12.0, 13.0});
+        CHECK_THROWS_AS(population.getAttribute<double>("attr-group", Selection({{0, 1}})),
+                        SonataError);
+        CHECK_THROWS_AS(population.size(), SonataError);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("NodePopulationConcurrentQueries", "[base]") {
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A");
+    const auto expected = population.getAttribute<double>("attr-X", population.selectAll());
+
+    std::vector<int> ok(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ok.size(); ++i) {
+        threads.emplace_back([&population, &expected, &ok, i] {
+            bool same = true;
+            for (int k = 0; k < 100; ++k) {
+                same = same && population.size() == 6 &&
+                       population._attributeDataType("attr-X") == "double" &&
+                       population._attributeDataType("E-mapping-good", true) == "string" &&
+                       population.getAttribute<double>("attr-X", population.selectAll()) ==
+                           expected;
+            }
+            ok[i] = same;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(ok == std::vector<int>(4, 1));
+    CHECK_THROWS_AS(population._attributeDataType("no-such-attribute"), SonataError);
+}
+
+TEST_CASE("NodePopulationHdf5ReaderOptions", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+
+    for (size_t min_gap_bytes : {size_t(0), size_t(8), size_t(4) << 20}) {
+        Hdf5ReaderOptions options;
+        options.min_gap_bytes = min_gap_bytes;
+        options.max_aggregated_block_bytes = 16;
+        options.chunk_aware = min_gap_bytes != 0;
+
+        const Hdf5Reader reader(options);
+        CHECK(reader.options().min_gap_bytes == min_gap_bytes);
+
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", reader);
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              reference.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              reference.getAttribute<std::string>("attr-Z", selection));
+    }
+
+    CHECK(Hdf5ReaderOptions().read_mode == Hdf5ReaderOptions::ReadMode::merge);
+    for (auto read_mode : {Hdf5ReaderOptions::ReadMode::automatic,
+                           Hdf5ReaderOptions::ReadMode::merge,
+                           Hdf5ReaderOptions::ReadMode::hyperslab}) {
+        Hdf5ReaderOptions options;
+        options.read_mode = read_mode;
+
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              reference.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              reference.getAttribute<std::string>("attr-Z", selection));
+        CHECK(population.getAttribute<uint64_t>("attr-Y", Selection({{5, 6}, {1, 3}})) ==
+              std::vector<uint64_t>{26, 22, 23});
+    }
+
+    {
+        Hdf5ReaderOptions options;
+        options.read_mode = Hdf5ReaderOptions::ReadMode::automatic;
+        options.min_gap_bytes = 0;
+        options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+
+        // Few ranges which aren't merged are read as a single hyperslab.
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              reference.getAttribute<double>("attr-X", selection));
+        CHECK(options.statistics->snapshot()["/nodes/nodes-A/0/attr-X"].n_read_calls == 1);
+    }
+
+    for (size_t n_reader_threads : {1, 2, 4}) {
+        Hdf5ReaderOptions options;
+        options.read_mode = Hdf5ReaderOptions::ReadMode::merge;
+        options.min_gap_bytes = 0;
+        options.chunk_aware = false;
+        options.n_reader_threads = n_reader_threads;
+        options.prefetch_depth = n_reader_threads - 1;
+
+        const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              reference.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              reference.getAttribute<std::string>("attr-Z", selection));
+    }
+}
+
+TEST_CASE("NodePopulationUnsortedSelections", "[base]") {
+    const NodePopulation serial("./data/nodes1.h5", "", "nodes-A");
+    const auto size = serial.size();
+    const auto column = serial.getAttribute<uint64_t>("attr-Y", serial.selectAll());
+
+    // Unsorted, overlapping ranges: more than 1024 of them are sorted with the
+    // radix sort, and more than 2^19 values are gathered by two threads.
+    const auto unsortedSelection = [size](size_t n_values) {
+        std::mt19937 rng(42);
+        Selection::Ranges ranges;
+        size_t n = 0;
+        while (ranges.size() <= 2048 || n < n_values) {
+            const auto begin = rng() % size;
+            const auto end = begin + 1 + rng() % (size - begin);
+            ranges.push_back({begin, end});
+            n += end - begin;
+        }
+        return Selection(std::move(ranges));
+    };
+
+    for (const auto& selection : {unsortedSelection(0), unsortedSelection(size_t(1) << 19)}) {
+        REQUIRE(!selection.isCanonical());
+
+        std::vector<uint64_t> sorted;
+        for (const auto& range : selection.ranges()) {
+            sorted.insert(sorted.end(),
+                          column.begin() + static_cast<std::ptrdiff_t>(std::get<0>(range)),
+                          column.begin() + static_cast<std::ptrdiff_t>(std::get<1>(range)));
+        }
+        REQUIRE(sorted.size() == selection.flatSize());
+        CHECK(serial.getAttribute<uint64_t>("attr-Y", selection) == sorted);
+
+        for (size_t n_reader_threads : {2, 4}) {
+            Hdf5ReaderOptions options;
+            options.n_reader_threads = n_reader_threads;
+
+            const NodePopulation population("./data/nodes1.h5",
+                                            "",
+                                            "nodes-A",
+                                            Hdf5Reader(options));
+            CHECK(population.getAttribute<uint64_t>("attr-Y", selection) == sorted);
+            CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+                  serial.getAttribute<std::string>("attr-Z", selection));
+        }
+    }
+}
+
+TEST_CASE("NodePopulationHdf5ReaderStatistics", "[base]") {
+    Hdf5ReaderOptions options;
+    options.read_mode = Hdf5ReaderOptions::ReadMode::merge;
+    options.min_gap_bytes = 0;
+    options.chunk_aware = false;
+    options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+    const std::string path = "/nodes/nodes-A/0/attr-X";
+
+    population.getAttribute<double>("attr-X", Selection({{0, 1}, {2, 4}, {5, 6}}));
+    auto snapshot = options.statistics->snapshot();
+    REQUIRE(snapshot.count(path) == 1);
+    CHECK(snapshot[path].n_read_calls == 3);
+    CHECK(snapshot[path].n_elements_requested == 4);
+    CHECK(snapshot[path].n_elements_read == 4);
+    CHECK(snapshot[path].n_canonicalizations == 0);
+    CHECK(std::accumulate(snapshot[path].latency_histogram.begin(),
+                          snapshot[path].latency_histogram.end(),
+                          size_t(0)) == 3);
+
+    population.getAttribute<double>("attr-X", Selection({{5, 6}, {0, 1}}));
+    snapshot = options.statistics->snapshot();
+    CHECK(snapshot[path].n_read_calls == 5);
+    CHECK(snapshot[path].n_elements_requested == 6);
+    CHECK(snapshot[path].n_canonicalizations == 1);
+
+    options.statistics->reset();
+    CHECK(options.statistics->snapshot().empty());
+}
+
+TEST_CASE("NodePopulationHdf5BlockCache", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+
+    Hdf5ReaderOptions options;
+    options.block_cache = std::make_shared<Hdf5BlockCache>(1 << 20, 2 * sizeof(double));
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+
+    const auto& cache = *options.block_cache;
+    CHECK(population.getAttribute<double>("attr-X", selection) ==
+          reference.getAttribute<double>("attr-X", selection));
+    CHECK(cache.hits() == 0);
+    CHECK(cache.misses() == 3);
+    CHECK(cache.bytes() == 6 * sizeof(double));
+
+    CHECK(population.getAttribute<double>("attr-X", Selection({{1, 2}, {5, 6}})) ==
+          reference.getAttribute<double>("attr-X", Selection({{1, 2}, {5, 6}})));
+    CHECK(cache.hits() == 2);
+    CHECK(cache.misses() == 3);
+
+    CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+          reference.getAttribute<std::string>("attr-Z", selection));
+    // A block holds a single std::string, i.e. one per selected value.
+    CHECK(cache.misses() == 7);
+
+    options.block_cache->clear();
+    CHECK(cache.bytes() == 0);
+}
+
+TEST_CASE("NodePopulationHdf5ColumnCache", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+
+    Hdf5ReaderOptions options;
+    options.column_cache = std::make_shared<Hdf5ColumnCache>(1 << 20);
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+
+    const auto& cache = *options.column_cache;
+    CHECK(population.getAttribute<double>("attr-X", selection) ==
+          reference.getAttribute<double>("attr-X", selection));
+    CHECK(cache.hits() == 0);
+    CHECK(cache.misses() == 1);
+    CHECK(cache.bytes() == 6 * sizeof(double));
+
+    CHECK(population.getAttribute<double>("attr-X", Selection({{5, 6}, {1, 2}})) ==
+          reference.getAttribute<double>("attr-X", Selection({{5, 6}, {1, 2}})));
+    const auto pred = [](const double v) { return v > 12.5; };
+    CHECK(population.filterAttribute<double>("attr-X", pred) ==
+          reference.filterAttribute<double>("attr-X", pred));
+    CHECK(cache.hits() == 2);
+    CHECK(cache.misses() == 1);
+
+    CHECK(population.matchAttributeValues<std::string>("attr-Z", "bb") ==
+          reference.matchAttributeValues<std::string>("attr-Z", "bb"));
+    CHECK(population.regexMatch("E-mapping-good", "^[AC]") ==
+          reference.regexMatch("E-mapping-good", "^[AC]"));
+    // The strings of "attr-Z", and the values and indices of "E-mapping-good".
+    CHECK(cache.misses() == 4);
+
+    population.evict();
+    CHECK(cache.bytes() == 0);
+
+    population.preload({"attr-Y", "E-mapping-good"});
+    const auto misses = cache.misses();
+    CHECK(population.getAttribute<std::string>("E-mapping-good", selection) ==
+          reference.getAttribute<std::string>("E-mapping-good", selection));
+    CHECK(cache.misses() == misses);
+
+    CHECK_THROWS_AS(reference.preload({"attr-X"}), SonataError);
+    CHECK_NOTHROW(reference.evict());
+}
+
+TEST_CASE("NodePopulationHdf5ColumnCacheTooLarge", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+
+    // Room for the `std::string`s of "attr-Z", but not for their characters.
+    Hdf5ReaderOptions options;
+    options.column_cache = std::make_shared<Hdf5ColumnCache>(6 * sizeof(std::string) + 4);
+    options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+    const std::string path = "/nodes/nodes-A/0/attr-Z";
+
+    const auto& cache = *options.column_cache;
+    CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+          reference.getAttribute<std::string>("attr-Z", selection));
+    CHECK(cache.bytes() == 0);
+    CHECK(options.statistics->snapshot()[path].n_elements_requested == 6);
+
+    // Only the selection is read from then on.
+    CHECK(population.getAttribute<std::string>("attr-Z", Selection({{1, 2}})) ==
+          reference.getAttribute<std::string>("attr-Z", Selection({{1, 2}})));
+    CHECK(cache.bytes() == 0);
+    CHECK(options.statistics->snapshot()[path].n_elements_requested == 7);
+}
+
+TEST_CASE("NodePopulationHdf5ReaderMemoryMap", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+
+    Hdf5ReaderOptions options;
+    options.memory_map = true;
+    options.statistics = std::make_shared<Hdf5ReaderStatistics>();
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+
+    CHECK(population.getAttribute<double>("attr-X", selection) ==
+          reference.getAttribute<double>("attr-X", selection));
+    // Mapped datasets are read with a single copy, instead of one HDF5 call per range.
+    CHECK(options.statistics->snapshot()["/nodes/nodes-A/0/attr-X"].n_read_calls == 1);
+
+    // Not stored as `float`, hence read through HDF5.
+    CHECK(population.getAttribute<float>("attr-X", selection) ==
+          reference.getAttribute<float>("attr-X", selection));
+    CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+          reference.getAttribute<std::string>("attr-Z", selection));
+    CHECK(population.getAttribute<double>("attr-X", Selection({{5, 6}, {0, 2}})) ==
+          reference.getAttribute<double>("attr-X", Selection({{5, 6}, {0, 2}})));
+
+    const auto expected = reference.getAttribute<double>("attr-X", Selection({{1, 4}}));
+    if (const auto view = population.getAttributeView<double>("attr-X", {1, 4})) {
+        CHECK(std::vector<double>(view.get(), view.get() + 3) == expected);
+    }
+    CHECK(population.getAttributeView<float>("attr-X", {1, 4}) == nullptr);
+    CHECK(reference.getAttributeView<double>("attr-X", {1, 4}) == nullptr);
+    CHECK_THROWS_AS(population.getAttributeView<double>("attr-X", {1, 100}), SonataError);
+}
+
+TEST_CASE("NodePopulationHdf5ReaderIoUring", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+
+    Hdf5ReaderOptions options;
+    options.io_uring_queue_depth = 2;
+    const NodePopulation population("./data/nodes1.h5", "", "nodes-A", Hdf5Reader(options));
+
+    for (const auto& selection : {Selection({{0, 1}, {2, 4}, {5, 6}}), Selection({{1, 5}})}) {
+        CHECK(population.getAttribute<double>("attr-X", selection) ==
+              reference.getAttribute<double>("attr-X", selection));
+        CHECK(population.getAttribute<float>("attr-X", selection) ==
+              reference.getAttribute<float>("attr-X", selection));
+        CHECK(population.getAttribute<std::string>("attr-Z", selection) ==
+              reference.getAttribute<std::string>("attr-Z", selection));
+    }
+}
+
+TEST_CASE("NodePopulationHdf5ReaderLocking", "[base]") {
+    const NodePopulation reference("./data/nodes1.h5", "", "nodes-A");
+    const auto selection = Selection({{0, 1}, {2, 4}, {5, 6}});
+    const auto expected_x = reference.getAttribute<double>("attr-X", selection);
+    const auto expected_z = reference.getAttribute<std::string>("attr-Z", selection);
+    const auto expected_e = reference.getAttribute<std::string>("E-mapping-good", selection);
+
+    for (const auto locking : {Hdf5ReaderOptions::Locking::automatic,
+                               Hdf5ReaderOptions::Locking::global,
+                               Hdf5ReaderOptions::Locking::per_file,
+                               Hdf5ReaderOptions::Locking::none}) {
+        Hdf5ReaderOptions options;
+        options.locking = locking;
+        const Hdf5Reader reader(options);
+        CHECK(reader.options().locking == locking);
+
+        const NodeStorage storage("./data/nodes1.h5", "", reader);
+        const auto population = storage.openPopulation("nodes-A");
+
+        std::vector<int> ok(4);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < ok.size(); ++i) {
+            threads.emplace_back([&, i] {
+                bool same = true;
+                for (int k = 0; k < 20; ++k) {
+                    same = same &&
+                           population->getAttribute<double>("attr-X", selection) == expected_x &&
+                           population->getAttribute<std::string>("attr-Z", selection) ==
+                               expected_z &&
+                           population->getAttribute<std::string>("E-mapping-good", selection) ==
+                               expected_e;
+                }
+                ok[i] = same;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK(ok == std::vector<int>(4, 1));
+    }
+}
+
 TEST_CASE("NodePopulationmatchAttributeValues", "[base]") {
     NodePopulation population("./data/nodes1.h5", "", "nodes-A");
 
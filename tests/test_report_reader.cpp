@@ -171,4 +171,15 @@ TEST_CASE("ElementReportReader", "[base]") {
     REQUIRE(ids == std::vector<CompartmentID>{{3, 5}, {3, 5}, {3, 6}, {3, 6}, {3, 7}, {4, 7}, {4, 8}, {4, 8}, {4, 9}, {4, 9}});
 
     REQUIRE_THROWS(pop.getNodeIdElementIdMapping(Selection({{3, 5}}), 4194303)); // < 1 x GPFS block
+
+    for (size_t prefetch_depth : {0, 1, 3}) {
+        const auto prefetched =
+            pop.get(sel, 0.2, 0.5, nonstd::nullopt, nonstd::nullopt, prefetch_depth);
+        REQUIRE(prefetched.ids == data.ids);
+        REQUIRE(prefetched.data == data.data);
+
+        const auto all = pop.get(
+            nonstd::nullopt, nonstd::nullopt, nonstd::nullopt, 2, nonstd::nullopt, prefetch_depth);
+        REQUIRE(all.data == pop.get(nonstd::nullopt, nonstd::nullopt, nonstd::nullopt, 2).data);
+    }
 }
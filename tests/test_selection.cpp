@@ -1,7 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <bbp/sonata/compressed_selection.h>
 #include <bbp/sonata/population.h>
 
+#include <numeric>  // std::iota
+
 
 using namespace bbp::sonata;
 
@@ -15,6 +18,41 @@ TEST_CASE("Selection", "[base]") {
         const auto selection = Selection::fromValues({1, 3, 4, 1});
         CHECK(selection.ranges() == Selection::Ranges{{1, 2}, {3, 5}, {1, 2}});
     }
+    SECTION("fromValues pointer") {
+        Selection::Values values(300000);
+        std::iota(values.begin(), values.begin() + 100000, 10);
+        std::iota(values.begin() + 100000, values.begin() + 100010, 5);
+        for (size_t i = 100010; i < values.size(); ++i) {
+            values[i] = (i / 7) * 11 + i % 7;
+        }
+        values[250000] = 3;
+        values[250001] = 3;
+
+        const auto expected = Selection::fromValues(values.begin(), values.end());
+        const auto* first = values.data();
+        const auto* last = values.data() + values.size();
+        CHECK(expected == Selection::fromValues(first, last));
+        for (size_t n_threads : {2, 3, 4, 7}) {
+            CHECK(expected == Selection::fromValues(first, last, n_threads));
+        }
+        CHECK(Selection({}) == Selection::fromValues(first, first, 4));
+    }
+
+    SECTION("fromMask") {
+        CHECK(Selection({}) == Selection::fromMask(static_cast<const uint8_t*>(nullptr), 0));
+
+        std::vector<uint8_t> mask(100, 0);
+        CHECK(Selection({}) == Selection::fromMask(mask.data(), mask.size()));
+        std::fill(mask.begin() + 3, mask.begin() + 40, 7);
+        mask[50] = 1;
+        mask[99] = 255;
+        CHECK(Selection({{3, 40}, {50, 51}, {99, 100}}) ==
+              Selection::fromMask(mask.data(), mask.size()));
+
+        const bool flags[] = {true, true, false, true};
+        CHECK(Selection({{0, 2}, {3, 4}}) == Selection::fromMask(flags, 4));
+    }
+
     SECTION("empty") {
         const auto selection = Selection({});
         CHECK(selection.ranges().empty());
@@ -31,6 +69,25 @@ TEST_CASE("Selection", "[base]") {
         CHECK(selection.flatSize() == 5);
         CHECK(!selection.empty());
     }
+    SECTION("iterator") {
+        const auto selection = Selection({{3, 5}, {0, 3}, {10, 11}});
+        CHECK(Selection::Values(selection.begin(), selection.end()) ==
+              Selection::Values{3, 4, 0, 1, 2, 10});
+
+        const auto empty = Selection({});
+        CHECK(empty.begin() == empty.end());
+
+        Selection::Values buffer(4);
+        auto it = selection.begin();
+        CHECK(it.fill(buffer.data(), 4) == 4);
+        CHECK(buffer == Selection::Values{3, 4, 0, 1});
+        CHECK(*it == 2);
+        CHECK(it.fill(buffer.data(), 4) == 2);
+        CHECK(buffer[0] == 2);
+        CHECK(buffer[1] == 10);
+        CHECK(it == selection.end());
+        CHECK(it.fill(buffer.data(), 4) == 0);
+    }
     SECTION("comparison") {
         const auto empty = Selection({});
         const auto range_selection = Selection({{0, 2}, {3, 4}});
@@ -102,6 +159,164 @@ TEST_CASE("Selection", "[base]") {
         CHECK(Selection({{0, 10}}) == (even | odd));
     }
 
+    SECTION("difference") {
+        const auto empty = Selection({});
+        CHECK(empty == (empty - empty));
+
+        // clang-format off
+        //              1         2
+        //    01234567890123456789012345
+        // a = xx   xxxxx   xxxxxxxxxx x
+        // b =  xxxxx  xxxxx  xxxxxxxx x
+        //     x     xx    x           <- a - b
+        //        xxx    xx            <- b - a
+        // clang-format on
+        const auto a = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}});
+        const auto b = Selection({{1, 6}, {8, 13}, {15, 23}, {24, 25}});
+        CHECK(b == (b - empty));
+        CHECK(empty == (empty - b));
+        CHECK(empty == (a - a));
+
+        CHECK(Selection({{0, 1}, {6, 8}, {13, 15}}) == (a - b));
+        CHECK(Selection({{2, 5}, {10, 13}}) == (b - a));
+
+        const auto odd = Selection::fromValues({1, 3, 5, 7, 9});
+        CHECK(Selection::fromValues({0, 2, 4, 6, 8}) == (Selection({{0, 10}}) - odd));
+    }
+
+    SECTION("symmetric difference") {
+        const auto empty = Selection({});
+        CHECK(empty == (empty ^ empty));
+
+        const auto a = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}});
+        const auto b = Selection({{1, 6}, {8, 13}, {15, 23}, {24, 25}});
+        CHECK(b == (b ^ empty));
+        CHECK(empty == (a ^ a));
+
+        const auto expected = Selection({{0, 1}, {2, 5}, {6, 8}, {10, 15}});
+        CHECK(expected == (a ^ b));
+        CHECK(expected == (b ^ a));
+    }
+
+    SECTION("complement") {
+        CHECK(Selection({}) == complement(Selection({}), 0));
+        CHECK(Selection({{0, 10}}) == complement(Selection({}), 10));
+        CHECK(Selection({}) == complement(Selection({{0, 10}}), 10));
+        CHECK(Selection({{0, 2}, {4, 5}, {8, 10}}) ==
+              complement(Selection({{5, 8}, {2, 4}, {12, 20}}), 10));
+    }
+
+    SECTION("unionAll and intersectAll") {
+        const auto empty = Selection({});
+        CHECK(empty == Selection::unionAll({}));
+        CHECK(empty == Selection::intersectAll({}));
+
+        const auto a = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}});
+        const auto b = Selection({{1, 6}, {8, 13}, {15, 23}, {24, 25}});
+        const auto c = Selection::fromValues({1, 9, 12, 16, 17, 30});
+
+        CHECK((a | b | c) == Selection::unionAll({a, b, c}));
+        CHECK((a | b | c) == Selection::unionAll({c, empty, b, a}));
+        CHECK((a & b & c) == Selection::intersectAll({a, b, c}));
+        CHECK(Selection({{1, 2}, {9, 10}, {16, 18}}) == Selection::intersectAll({c, b, a}));
+        CHECK(empty == Selection::intersectAll({a, empty, b}));
+
+        CHECK(Selection({{0, 2}}) == Selection::unionAll({Selection({{0, 1}, {1, 2}})}));
+        CHECK(Selection({{0, 2}}) == Selection::intersectAll({Selection({{0, 1}, {1, 2}})}));
+    }
+
+    SECTION("serialize") {
+        const auto roundtrip = [](const Selection& selection) {
+            return Selection::deserialize(selection.serialize());
+        };
+
+        CHECK(Selection({}) == roundtrip(Selection({})));
+
+        const auto unsorted = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}, {0, 2}, {1, 5}});
+        CHECK(unsorted == roundtrip(unsorted));
+
+        const auto large = Selection({{0, 1}, {uint64_t(-2), uint64_t(-1)}, {3, 4}});
+        CHECK(large == roundtrip(large));
+
+        // dense region of short ranges, stored as a bitmap
+        Selection::Values values;
+        for (Selection::Value v = 1000; v < 2000; v += 3) {
+            values.push_back(v);
+        }
+        values.push_back(1);
+        const auto dense = Selection::fromValues(values);
+        const auto serialized = dense.serialize();
+        CHECK(dense == Selection::deserialize(serialized));
+        CHECK(serialized.size() < 2 * dense.ranges().size());
+
+        CHECK_THROWS_AS(Selection::deserialize({}), SonataError);
+        CHECK_THROWS_AS(Selection::deserialize({255}), SonataError);
+
+        auto truncated = dense.serialize();
+        truncated.pop_back();
+        CHECK_THROWS_AS(Selection::deserialize(truncated), SonataError);
+
+        auto trailing = unsorted.serialize();
+        trailing.push_back(0);
+        CHECK_THROWS_AS(Selection::deserialize(trailing), SonataError);
+    }
+
+    SECTION("partition") {
+        CHECK_THROWS_AS(Selection({}).partition(0), SonataError);
+
+        const auto empty_parts = Selection({}).partition(3);
+        REQUIRE(empty_parts.size() == 3);
+        for (const auto& part : empty_parts) {
+            CHECK(part.empty());
+        }
+
+        const auto a = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}});
+        CHECK(std::vector<Selection>{a | Selection({})} == a.partition(1));
+
+        const auto parts = a.partition(3);
+        REQUIRE(parts.size() == 3);
+        CHECK(Selection({{0, 2}, {5, 9}}) == parts[0]);
+        CHECK(Selection({{9, 10}, {13, 18}}) == parts[1]);
+        CHECK(Selection({{18, 23}, {24, 25}}) == parts[2]);
+
+        const auto many = Selection({{0, 2}}).partition(4);
+        REQUIRE(many.size() == 4);
+        CHECK(Selection({}) == many[0]);
+        CHECK(Selection({{0, 1}}) == many[1]);
+        CHECK(Selection({}) == many[2]);
+        CHECK(Selection({{1, 2}}) == many[3]);
+    }
+
+    SECTION("partitionByReadCost") {
+        // with a gap of 100, 0..100 is read as one block
+        const auto a = Selection({{1000, 1010}, {0, 1}, {50, 51}, {99, 100}});
+        const auto by_size = a.partition(2);
+        CHECK(Selection({{0, 1}, {50, 51}, {99, 100}, {1000, 1003}}) == by_size[0]);
+        CHECK(Selection({{1003, 1010}}) == by_size[1]);
+
+        const auto by_cost = a.partitionByReadCost(2, 100);
+        CHECK(Selection({{0, 1}, {50, 51}}) == by_cost[0]);
+        CHECK(Selection({{99, 100}, {1000, 1010}}) == by_cost[1]);
+
+        // blocks are capped at 10 elements: 0..51, 99..100 and 1000..1010
+        const auto capped = a.partitionByReadCost(2, 100, 10);
+        CHECK(Selection({{0, 1}}) == capped[0]);
+        CHECK(Selection({{50, 51}, {99, 100}, {1000, 1010}}) == capped[1]);
+    }
+
+    SECTION("isCanonical") {
+        CHECK(Selection({}).isCanonical());
+        CHECK(Selection({{0, 2}, {2, 4}, {5, 6}}).isCanonical());
+        CHECK(!Selection({{2, 4}, {0, 2}}).isCanonical());
+        CHECK(!Selection({{0, 3}, {2, 4}}).isCanonical());
+
+        // overlapping and touching ranges are coalesced
+        const auto overlapping = Selection({{0, 3}, {2, 4}, {4, 5}});
+        CHECK(Selection({{0, 5}}) == (overlapping | Selection({})));
+        CHECK(Selection({{0, 5}}) == (overlapping & Selection({{0, 10}})));
+        CHECK(Selection({{0, 5}}) == (overlapping - Selection({})));
+    }
+
     /*  need a way to test un-exported stuff
     SECTION("_sortAndMerge") {
         const auto empty = Selection::Ranges({});
@@ -123,3 +338,101 @@ TEST_CASE("Selection", "[base]") {
     }
     */
 }
+
+TEST_CASE("CompressedSelection", "[base]") {
+    using Kind = detail::CompressedBlock::Kind;
+
+    SECTION("empty") {
+        const auto empty = CompressedSelection(Selection({}));
+        CHECK(empty.empty());
+        CHECK(empty.ranges().empty());
+        CHECK(empty.flatten().empty());
+        CHECK(empty.flatSize() == 0);
+        CHECK(empty == CompressedSelection());
+    }
+
+    SECTION("canonical ranges") {
+        const auto selection = CompressedSelection(Selection({{5, 10}, {0, 2}, {2, 3}, {7, 12}}));
+        CHECK(selection.ranges() == Selection::Ranges{{0, 3}, {5, 12}});
+        CHECK(selection.flatten() == Selection::Values{0, 1, 2, 5, 6, 7, 8, 9, 10, 11});
+        CHECK(selection.flatSize() == 10);
+        CHECK(selection.toSelection() == Selection({{0, 3}, {5, 12}}));
+        CHECK(selection.contains(2));
+        CHECK(!selection.contains(3));
+        CHECK(selection.contains(11));
+        CHECK(!selection.contains(12));
+    }
+
+    SECTION("block kinds") {
+        // one long run
+        const auto runs = CompressedSelection(Selection({{0, 60000}}));
+        REQUIRE(runs.blocks().size() == 1);
+        CHECK(runs.blocks()[0].kind == Kind::runs);
+
+        // few isolated values
+        const auto array = CompressedSelection::fromValues({1, 3, 5, 7, 1000});
+        REQUIRE(array.blocks().size() == 1);
+        CHECK(array.blocks()[0].kind == Kind::array);
+        CHECK(array.memoryUsage() < 5 * sizeof(Selection::Range));
+
+        // many isolated values
+        Selection::Values even;
+        for (Selection::Value v = 0; v < (1 << 16); v += 2) {
+            even.push_back(v);
+        }
+        const auto bitmap = CompressedSelection::fromValues(even);
+        REQUIRE(bitmap.blocks().size() == 1);
+        CHECK(bitmap.blocks()[0].kind == Kind::bitmap);
+        CHECK(bitmap.flatSize() == even.size());
+        CHECK(bitmap.flatten() == even);
+        CHECK(bitmap.contains(65534));
+        CHECK(!bitmap.contains(65535));
+    }
+
+    SECTION("ranges spanning blocks") {
+        const Selection::Value big = uint64_t(1) << 40;
+        const auto selection = CompressedSelection(
+            Selection({{65530, 65540}, {3 * 65536 - 1, 5 * 65536 + 1}, {big, big + 1}}));
+        CHECK(selection.ranges() ==
+              Selection::Ranges{{65530, 65540}, {3 * 65536 - 1, 5 * 65536 + 1}, {big, big + 1}});
+        CHECK(selection.flatSize() == 10 + 2 * 65536 + 2 + 1);
+    }
+
+    SECTION("intersection and union") {
+        // clang-format off
+        //              1         2
+        //    01234567890123456789012345
+        // a = xx   xxxxx   xxxxxxxxxx x
+        // b =  xxxxx  xxxxx  xxxxxxxx x
+        // clang-format on
+        const auto a = Selection({{24, 25}, {13, 23}, {5, 10}, {0, 2}});
+        const auto b = Selection({{1, 6}, {8, 13}, {15, 23}, {24, 25}});
+        const auto ca = CompressedSelection(a);
+        const auto cb = CompressedSelection(b);
+        const auto empty = CompressedSelection();
+
+        CHECK((ca & cb).ranges() == (a & b).ranges());
+        CHECK((cb & ca) == (ca & cb));
+        CHECK((ca | cb).ranges() == (a | b).ranges());
+        CHECK((cb | ca) == (ca | cb));
+        CHECK((ca & empty) == empty);
+        CHECK((ca | empty) == ca);
+
+        Selection::Values odd_values, even_values;
+        for (Selection::Value v = 0; v < 3 * (1 << 16); ++v) {
+            (v % 2 == 0 ? even_values : odd_values).push_back(v);
+        }
+        const auto odd = CompressedSelection::fromValues(odd_values);
+        const auto even = CompressedSelection::fromValues(even_values);
+        CHECK((odd & even).empty());
+        CHECK((odd | even).ranges() == Selection::Ranges{{0, 3 * (1 << 16)}});
+        CHECK((odd | even).blocks()[0].kind == Kind::runs);
+
+        // mixed kinds: bitmap with array and runs
+        const auto sparse = CompressedSelection::fromValues({2, 3, 70000, 70001});
+        CHECK((even & sparse).ranges() == Selection::Ranges{{2, 3}, {70000, 70001}});
+        CHECK((even | sparse).flatSize() == even.flatSize() + 2);
+        const auto dense = CompressedSelection(Selection({{10, 20}, {65530, 131072}}));
+        CHECK((odd & dense).flatSize() == 5 + 3 + 32768);
+    }
+}